@@ -6,6 +6,7 @@ set(APP_NAME ${ALWF_APP_NAME})
 
 set(CMAKE_EXPORT_COMPILE_COMMANDS ON)
 option(USE_ASAN "Use Address Sanitizer" OFF)
+option(ALWF_HTTP_TRANSPORT "Build the loopback HTTP transport (Options::http_port) into release builds" OFF)
 
 add_compile_options(
     "$<$<CONFIG:Debug>:-g;-O0;-Wall>"
@@ -74,15 +75,17 @@ set(GENERATED_DIR "${CMAKE_BINARY_DIR}/templates")
 file(GLOB AT_FILES "${ALWF_VIEWS_DIR}/*.at")
 set(GENERATED_HEADERS)
 
+if(UNIX)
+    set(LD_PREFIX LD_LIBRARY_PATH=${APP_LIB_DIR})
+endif()
+
+# One ahtt command per view keeps a DEPFILE per header, so an edit only recompiles the views that include the
+# changed template; the generator runs these commands concurrently.
 foreach(AT_FILE ${AT_FILES})
     get_filename_component(AT_NAME "${AT_FILE}" NAME_WE)
     set(OUT_HEADER "${GENERATED_DIR}/${AT_NAME}.hpp")
     set(DEP_FILE "${GENERATED_DIR}/${AT_NAME}.dep")
 
-    if(UNIX)
-        set(LD_PREFIX LD_LIBRARY_PATH=${APP_LIB_DIR})
-    endif()
-
     add_custom_command(
         OUTPUT "${OUT_HEADER}"
         COMMAND ${LD_PREFIX} $<TARGET_FILE:ahtt>
@@ -96,14 +99,99 @@ foreach(AT_FILE ${AT_FILES})
         VERBATIM
     )
 
+    list(APPEND ASSET_VIEW_LIST "${AT_NAME}|${AT_FILE}|${DEP_FILE}|${GENERATED_DIR}/${AT_NAME}_assets.hpp")
+    list(APPEND ASSET_HEADERS "${GENERATED_DIR}/${AT_NAME}_assets.hpp")
     list(APPEND GENERATED_HEADERS "${OUT_HEADER}")
 endforeach()
 
+# Asset sets of all views and their includes (Router::assets), extracted in a single pass so shared layouts are
+# read once. Unchanged headers are not rewritten.
+set(ASSETS_VIEW_FILE "${GENERATED_DIR}/assets_views.txt")
+string(REPLACE ";" "\n" ASSET_VIEW_LINES "${ASSET_VIEW_LIST}")
+file(WRITE "${ASSETS_VIEW_FILE}.in" "${ASSET_VIEW_LINES}\n")
+configure_file("${ASSETS_VIEW_FILE}.in" "${ASSETS_VIEW_FILE}" COPYONLY)
+set(ASSETS_STAMP "${GENERATED_DIR}/assets.stamp")
+add_custom_command(
+    OUTPUT "${ASSETS_STAMP}"
+    BYPRODUCTS ${ASSET_HEADERS}
+    COMMAND ${CMAKE_COMMAND} -DVIEW_LIST=${ASSETS_VIEW_FILE} -P "${CMAKE_CURRENT_LIST_DIR}/tools/asset_deps.cmake"
+    COMMAND ${CMAKE_COMMAND} -E touch "${ASSETS_STAMP}"
+    DEPENDS ${GENERATED_HEADERS} "${ASSETS_VIEW_FILE}" "${CMAKE_CURRENT_LIST_DIR}/tools/asset_deps.cmake"
+    COMMENT "Extract view asset sets"
+    VERBATIM
+)
+list(APPEND GENERATED_HEADERS "${ASSETS_STAMP}")
+
 add_custom_target(generate_at_templates
     DEPENDS ${GENERATED_HEADERS}
 )
 list(APPEND DEPENDENT_TARGETS generate_at_templates)
 
+# Static views: rendered once at build time into templates/<view>_static.hpp
+# Static views are rendered once on the build host: a localized view would ship in the build machine's language
+if(DEFINED ALWF_STATIC_VIEWS)
+    set(PRERENDER_DIR "${CMAKE_BINARY_DIR}/prerender")
+    set(PRERENDER_LIST "")
+    set(PRERENDER_INCLUDES "")
+    set(PRERENDER_OUTPUTS)
+    foreach(VIEW ${ALWF_STATIC_VIEWS})
+        string(APPEND PRERENDER_INCLUDES "#include <templates/${VIEW}.hpp>\n")
+        string(APPEND PRERENDER_LIST " X(${VIEW})")
+        list(APPEND PRERENDER_OUTPUTS "${GENERATED_DIR}/${VIEW}_static.hpp")
+    endforeach()
+    file(WRITE "${PRERENDER_DIR}/prerender_views.hpp.in"
+        "${PRERENDER_INCLUDES}#define ALWF_STATIC_VIEW_LIST(X)${PRERENDER_LIST}\n")
+    configure_file("${PRERENDER_DIR}/prerender_views.hpp.in" "${PRERENDER_DIR}/prerender_views.hpp" COPYONLY)
+
+    add_executable(alwf_prerender EXCLUDE_FROM_ALL "${CMAKE_CURRENT_LIST_DIR}/tools/prerender.cpp")
+    add_dependencies(alwf_prerender generate_at_templates)
+    target_include_directories(alwf_prerender PRIVATE ${CMAKE_CURRENT_BINARY_DIR} ${PRERENDER_DIR})
+    target_link_libraries(alwf_prerender PRIVATE acul)
+    set_target_properties(alwf_prerender PROPERTIES CXX_STANDARD 23 CXX_STANDARD_REQUIRED YES)
+
+    add_custom_command(
+        OUTPUT ${PRERENDER_OUTPUTS}
+        COMMAND ${LD_PREFIX} $<TARGET_FILE:alwf_prerender> "${GENERATED_DIR}"
+        DEPENDS alwf_prerender ${GENERATED_HEADERS}
+        WORKING_DIRECTORY ${APP_LIB_DIR}
+        COMMENT "Prerender static views: ${ALWF_STATIC_VIEWS}"
+        VERBATIM
+    )
+    add_custom_target(prerender_static_views DEPENDS ${PRERENDER_OUTPUTS})
+    list(APPEND DEPENDENT_TARGETS prerender_static_views)
+endif()
+
+# Headless benchmarks of the dispatch core: cmake -DALWF_BENCH=ON, then build and run alwf_bench
+if(ALWF_BENCH)
+    file(GLOB ALWF_CORE_SRC "${CMAKE_CURRENT_LIST_DIR}/src/internal/*.cpp")
+    file(GLOB ALWF_BENCH_SRC "${CMAKE_CURRENT_LIST_DIR}/bench/*.cpp")
+    add_executable(alwf_bench EXCLUDE_FROM_ALL ${ALWF_CORE_SRC} ${ALWF_BENCH_SRC})
+    add_dependencies(alwf_bench generate_at_templates)
+    target_compile_definitions(alwf_bench PRIVATE ALWF_HEADLESS)
+    target_include_directories(alwf_bench PRIVATE
+        ${CMAKE_CURRENT_BINARY_DIR} ${ALWF_ROOT_DIR}/include ${CMAKE_CURRENT_LIST_DIR}/src)
+    if(DEFINED ALWF_STATIC_VIEWS)
+        target_compile_definitions(alwf_bench PRIVATE ALWF_BENCH_VIEWS)
+        target_include_directories(alwf_bench PRIVATE ${PRERENDER_DIR})
+    endif()
+    target_link_libraries(alwf_bench PRIVATE acul)
+    set_target_properties(alwf_bench PROPERTIES CXX_STANDARD 23 CXX_STANDARD_REQUIRED YES)
+endif()
+
+# Headless replay of Options::capture_file recordings against the application's routes. ALWF_REPLAY_SOURCES lists
+# the application files that define alwf::replay_setup (alwf/replay.hpp); then build and run alwf_replay.
+if(DEFINED ALWF_REPLAY_SOURCES)
+    file(GLOB ALWF_CORE_SRC "${CMAKE_CURRENT_LIST_DIR}/src/internal/*.cpp")
+    add_executable(alwf_replay EXCLUDE_FROM_ALL ${ALWF_CORE_SRC} "${CMAKE_CURRENT_LIST_DIR}/bench/headless.cpp"
+        "${CMAKE_CURRENT_LIST_DIR}/tools/replay.cpp" ${ALWF_REPLAY_SOURCES})
+    add_dependencies(alwf_replay generate_at_templates)
+    target_compile_definitions(alwf_replay PRIVATE ALWF_HEADLESS)
+    target_include_directories(alwf_replay PRIVATE ${CMAKE_CURRENT_BINARY_DIR} ${ALWF_ROOT_DIR}/include
+        ${CMAKE_CURRENT_LIST_DIR}/src ${CMAKE_CURRENT_LIST_DIR}/bench)
+    target_link_libraries(alwf_replay PRIVATE acul)
+    set_target_properties(alwf_replay PROPERTIES CXX_STANDARD 23 CXX_STANDARD_REQUIRED YES)
+endif()
+
 normalize_variable_name(PROJECT_NAME SRC_PREFIX)
 add_executable(${PROJECT_NAME} ${${SRC_PREFIX}_SRC})
 
@@ -132,6 +220,21 @@ if(DEFINED ALFW_LOCALES_SRC)
 
     add_custom_target(LOCALES DEPENDS ${LOCALE_FILES})
     list(APPEND DEPENDENT_TARGETS LOCALES)
+
+    # Constant string table for alwf::tr(), so renders need no gettext lookups
+    set(STRINGS_HEADER "${GENERATED_DIR}/strings.hpp")
+    add_custom_command(
+        OUTPUT "${STRINGS_HEADER}"
+        COMMAND ${CMAKE_COMMAND}
+        -DLOCALES_SRC=${ALFW_LOCALES_SRC}
+        -DOUT_HEADER=${STRINGS_HEADER}
+        -P "${CMAKE_CURRENT_LIST_DIR}/tools/l10n_table.cmake"
+        DEPENDS ${LOCALES_SRC} "${CMAKE_CURRENT_LIST_DIR}/tools/l10n_table.cmake"
+        COMMENT "Generate string table: ${STRINGS_HEADER}"
+        VERBATIM
+    )
+    add_custom_target(LOCALE_STRINGS DEPENDS ${STRINGS_HEADER})
+    list(APPEND DEPENDENT_TARGETS LOCALE_STRINGS)
 endif()
 
 # Resources
@@ -172,9 +275,12 @@ endif()
 target_include_directories(${PROJECT_NAME} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
 target_include_directories(${PROJECT_NAME} PRIVATE ${ALWF_ROOT_DIR}/include)
 target_link_libraries(${PROJECT_NAME} PRIVATE acul)
+if(ALWF_HTTP_TRANSPORT)
+    target_compile_definitions(${PROJECT_NAME} PRIVATE ALWF_HTTP_TRANSPORT)
+endif()
 
 if(WIN32)
-    target_link_libraries(${PROJECT_NAME} PRIVATE shlwapi awin)
+    target_link_libraries(${PROJECT_NAME} PRIVATE shlwapi ws2_32 awin)
 else()
     find_package(PkgConfig REQUIRED)
     pkg_check_modules(GTK3 REQUIRED gtk+-3.0)
@@ -0,0 +1,156 @@
+// Throughput and allocation counts of the dispatch core, without a web view.
+// Usage: alwf_bench [results.jsonl]. Each case prints ns/op, ops/s and operator new calls per op; the optional
+// file receives the same numbers as JSON lines for tracking across builds.
+#include <alwf/views.hpp>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include "headless.hpp"
+#ifdef ALWF_BENCH_VIEWS
+    #include "prerender_views.hpp"
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    FILE *results = nullptr;
+
+    template <typename F>
+    void run(const char *name, F &&fn)
+    {
+        for (int i = 0; i < 1000; ++i) fn(); // warm up caches and lazily built state
+
+        u64 ops = 0;
+        u64 allocs_before = alwf::allocation_count();
+        auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(500))
+        {
+            for (int i = 0; i < 1000; ++i) fn();
+            ops += 1000;
+            elapsed = Clock::now() - start;
+        }
+        u64 allocs = alwf::allocation_count() - allocs_before;
+
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (double)ops;
+        double per_op = (double)allocs / (double)ops;
+        printf("%-28s %10.1f ns/op %12.0f ops/s %8.2f allocs/op\n", name, ns, 1e9 / ns, per_op);
+        if (results)
+            fprintf(results, "{\"name\":\"%s\",\"ns_per_op\":%.1f,\"ops_per_sec\":%.0f,\"allocs_per_op\":%.2f}\n", name,
+                    ns, 1e9 / ns, per_op);
+    }
+
+    alwf::Request make_request(alwf::Method method, const char *uri, const alwf::HeaderMap *headers = nullptr)
+    {
+        alwf::Request req;
+        req.method = method;
+        req.request_ctx = nullptr;
+        req.headers = headers;
+        alwf::parse_request_url(uri, req);
+        return req;
+    }
+
+    void dispatch(const alwf::Request &req)
+    {
+        alwf::DispatchResult result = alwf::dispatch_request(req);
+        if (result.kind == alwf::DispatchKind::owned) acul::release(result.res);
+    }
+
+    acul::string render_list(int rows)
+    {
+        acul::string html = "<ul>";
+        for (int i = 0; i < rows; ++i) html.append(acul::format("<li>Row %d</li>", i));
+        html.append("</ul>");
+        return html;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && !(results = fopen(argv[1], "w")))
+    {
+        fprintf(stderr, "alwf_bench: cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    static const char page[] = "<!doctype html><html><head><title>Bench</title></head><body>Bench</body></html>";
+    const std::filesystem::path static_dir = std::filesystem::temp_directory_path() / "alwf_bench";
+    std::filesystem::create_directories(static_dir);
+    if (FILE *f = fopen((static_dir / "style.css").string().c_str(), "wb"))
+    {
+        for (int i = 0; i < 512; ++i) fputs(".row { margin: 0; padding: 4px; }\n", f);
+        fclose(f);
+    }
+    const std::string static_folder = static_dir.string();
+
+    alwf::Router router;
+    for (int i = 0; i < 256; ++i)
+        router.get[acul::format("/route/%d", i)] = [](const alwf::Request &) -> alwf::IResponse * {
+            return acul::alloc<alwf::BinaryViewResponse>(page, sizeof(page) - 1, "text/html");
+        };
+    router.get["/json"] = [](const alwf::Request &) -> alwf::IResponse * {
+        rapidjson::Document d;
+        d.SetObject();
+        auto &a = d.GetAllocator();
+        for (int i = 0; i < 32; ++i)
+            d.AddMember(rapidjson::Value(acul::format("key%d", i).c_str(), a), rapidjson::Value(i), a);
+        return acul::alloc<alwf::JSONResponse>(std::move(d));
+    };
+    router.get["/json/cached"] = router.get["/json"];
+    router.cache["/json/cached"] = alwf::RouteCachePolicy{60000, 32};
+    static alwf::ViewCache<int> list_view(render_list);
+    router.get["/view"] = [](const alwf::Request &) { return list_view(100); };
+
+    alwf::HandlerRouter handlers;
+    u64 handled = 0;
+    handlers["bench"] = [&handled](const rapidjson::Value &) { ++handled; };
+
+    alwf::ctx = acul::alloc<alwf::Context>();
+    alwf::ctx->static_folder = static_folder.c_str();
+    alwf::ctx->router = &router;
+    alwf::ctx->handler_router = &handlers;
+    alwf::ctx->call_router = nullptr;
+    alwf::ctx->strings = nullptr;
+    alwf::ctx->call_timeout_ms = 30000;
+    alwf::ctx->blob_ttl_ms = 60000;
+    alwf::ctx->prerender_links = false;
+    alwf::ctx->prerender_budget = 0;
+    alwf::ctx->prerender_ttl_ms = 0;
+    alwf::ctx->memory_low_water = 0;
+
+    alwf::HeaderMap html_headers{{"accept", "text/html"}};
+    const alwf::Request route_hit = make_request(alwf::Method::get, "/route/128", &html_headers);
+    const alwf::Request json_route = make_request(alwf::Method::get, "/json");
+    const alwf::Request cached_route = make_request(alwf::Method::get, "/json/cached?b=2&a=1");
+    const alwf::Request view_route = make_request(alwf::Method::get, "/view");
+    const alwf::Request static_hit = make_request(alwf::Method::get, "/style.css");
+    const alwf::Request static_miss = make_request(alwf::Method::get, "/missing.css");
+
+    run("route_lookup", [&] { dispatch(route_hit); });
+    run("static_cache_hit", [&] { dispatch(static_hit); });
+    run("static_cache_miss", [&] { dispatch(static_miss); });
+    run("json_response", [&] { dispatch(json_route); });
+    run("route_cache_hit", [&] { dispatch(cached_route); });
+    run("view_cache_hit", [&] { dispatch(view_route); });
+    run("view_render", [] { acul::string html = render_list(100); });
+#ifdef ALWF_BENCH_VIEWS
+    #define ALWF_BENCH_VIEW(name) run("render_" #name, [] { acul::string html = ahtt::name::render(); });
+    ALWF_STATIC_VIEW_LIST(ALWF_BENCH_VIEW)
+#endif
+    run("message_dispatch", [] { alwf::dispatch_message(R"({"handler":"bench","data":{"id":42,"text":"hello"}})"); });
+    run("parse_request_url", [] {
+        alwf::Request req;
+        alwf::parse_request_url("/search?q=alwf&page=2", req);
+    });
+
+    alwf::drain_main_queue();
+    alwf::destroy_blobs();
+    alwf::destroy_prerender_cache();
+    alwf::destroy_route_cache();
+    alwf::destroy_page_assets();
+    acul::release(alwf::ctx);
+    alwf::ctx = nullptr;
+    if (results) fclose(results);
+    return handled ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Platform layer for running the dispatch core without a window. Tasks posted to the main thread run on the
+// next drain_main_queue() call; messages to the page are counted and dropped.
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include "headless.hpp"
+
+static std::atomic<u64> allocations{0};
+
+void *operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+namespace alwf
+{
+    static std::mutex queue_lock;
+    static acul::vector<std::function<void()>> queue;
+    static u64 sent_messages = 0;
+
+    acul::string Request::get_header(const ACUL_NATIVE_CHAR *header) const
+    {
+        if (!headers || !header) return {};
+        return find_header(*headers, (const char *)header);
+    }
+
+    void post_to_main(std::function<void()> &&task)
+    {
+        std::lock_guard<std::mutex> lock(queue_lock);
+        queue.push_back(std::move(task));
+    }
+
+    void post_idle(std::function<void()> &&task) { post_to_main(std::move(task)); }
+
+    // No clock to wait on: the task runs on the next drain like any other
+    void post_delayed(u32, std::function<void()> &&task) { post_to_main(std::move(task)); }
+
+    void send_raw_to_frontend(const acul::string &, WindowId) { ++sent_messages; }
+
+    void send_json_to_window(WindowId id, const rapidjson::Value &json)
+    {
+        rapidjson::StringBuffer buf;
+        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+        json.Accept(w);
+        send_raw_to_frontend(acul::string(buf.GetString(), buf.GetSize()), id);
+    }
+
+    void send_json_to_frontend(const rapidjson::Value &json) { send_json_to_window(all_windows, json); }
+
+    // A single main window without a page
+    size_t window_count() { return 1; }
+
+    acul::vector<WindowId> window_ids() { return {main_window}; }
+
+    void drain_main_queue()
+    {
+        acul::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(queue_lock);
+            tasks.swap(queue);
+        }
+        for (auto &task : tasks) task();
+    }
+
+    u64 frontend_message_count() { return sent_messages; }
+
+    u64 allocation_count() { return allocations.load(std::memory_order_relaxed); }
+
+    void init_stack_sampler() {}
+
+    bool sample_main_stack(acul::string &) { return false; }
+    void set_web_memory_low(bool) {}
+    void collect_web_garbage() {}
+} // namespace alwf
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <internal/framework.hpp>
+
+namespace alwf
+{
+    void drain_main_queue();
+    u64 frontend_message_count();
+
+    // operator new calls so far. headless.cpp replaces the global operator new to count them.
+    u64 allocation_count();
+} // namespace alwf
@@ -1,13 +1,13 @@
-document.addEventListener("DOMContentLoaded", () => {
+let offApiDemo = null;
+
+function initApiDemo() {
   const input   = document.getElementById("api-input");
   const sendBtn = document.getElementById("api-send");
   const form    = document.getElementById("send-form");
   const log     = document.getElementById("api-log");
 
-  if (!input || !sendBtn || !form || !log) {
-    console.warn("API Demo elements not found");
-    return;
-  }
+  if (offApiDemo) { offApiDemo(); offApiDemo = null; }
+  if (!input || !sendBtn || !form || !log) return;
 
   input.addEventListener("input", () => {
     sendBtn.disabled = !input.value.trim();
@@ -25,7 +25,7 @@ document.addEventListener("DOMContentLoaded", () => {
     sendBtn.disabled = true;
   });
 
-  alwf.on("api-demo", response => {
+  offApiDemo = alwf.on("api-demo", response => {
     appendLog("RESPONSE", JSON.stringify(response, null, 2));
   });
 
@@ -40,4 +40,9 @@ document.addEventListener("DOMContentLoaded", () => {
       <pre>${text}</pre>`;
     log.prepend(item);
   }
-});
\ No newline at end of file
+}
+
+// The script stays loaded across in-page navigation, so re-initialise whenever the API page is swapped in
+if (document.readyState === "loading") document.addEventListener("DOMContentLoaded", initApiDemo);
+else initApiDemo();
+document.addEventListener("alwf:navigate", initApiDemo);
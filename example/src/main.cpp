@@ -1,15 +1,23 @@
 #include <acul/io/path.hpp>
 #include <acul/locales/locales.hpp>
 #include <alwf/alwf.hpp>
+#include <alwf/l10n.hpp>
+#include <alwf/views.hpp>
 #include <templates/api.hpp>
-#include <templates/start.hpp>
+#include <templates/api_assets.hpp>
+#include <templates/start_assets.hpp>
+#include <templates/start_static.hpp>
+#include <templates/strings.hpp>
 #include "handlers.hpp"
 
 int main(int argc, char **argv)
 {
     alwf::Router router;
-    router.get["/"] = [](const alwf::Request &) { return acul::alloc<alwf::TextResponse>(ahtt::start::render()); };
-    router.get["/api"] = [](const alwf::Request &) { return acul::alloc<alwf::TextResponse>(ahtt::api::render()); };
+    router.get["/"] = alwf::static_view(ahtt::start::prerendered::data, ahtt::start::prerendered::size);
+    static alwf::ViewCache<> api_view(ahtt::api::render);
+    router.get["/api"] = [](const alwf::Request &) { return api_view(); };
+    router.assets["/"] = ahtt::start::assets::items;
+    router.assets["/api"] = ahtt::api::assets::items;
 
     alwf::HandlerRouter api_router;
     api_router.emplace("api-demo", api_message);
@@ -21,13 +29,14 @@ int main(int argc, char **argv)
     opt.height = 800;
 
     acul::path current_path = acul::io::get_current_path();
-    // i18n (Actually not used in this example)
+    // i18n
     const char *languages[] = {"en", "ru"};
     opt.languages = languages;
     opt.language_count = 2;
     opt.gettext_domain = "app";
     acul::string locales_path = current_path / "locales";
     opt.locales_dir = locales_path.c_str();
+    opt.strings = &alwf::strings::table;
 
     // Public files
     acul::string static_folder = current_path / "public";
@@ -36,6 +45,7 @@ int main(int argc, char **argv)
     // Navigation
     opt.router = &router;
     opt.handler_router = &api_router;
+    opt.prerender_links = true;
 
     alwf::init(opt);
     alwf::run();
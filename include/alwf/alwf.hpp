@@ -18,13 +18,17 @@ namespace alwf
         del
     };
 
+    // Lowercase header names to values
+    using HeaderMap = acul::hashmap<acul::string, acul::string>;
+
     struct Request
     {
         Method method;
         acul::string path;
         acul::string query;
         acul::string body;
-        void *request_ctx;
+        void *request_ctx;                  // native web view headers
+        const HeaderMap *headers = nullptr; // set instead for requests parsed by alwf (loopback HTTP, headless)
 
         acul::string get_header(const ACUL_NATIVE_CHAR *header) const;
     };
@@ -52,6 +56,11 @@ namespace alwf
         {
         }
 
+        TextResponse(acul::string &&content, const char *content_type = "text/html")
+            : IResponse(content_type), content(std::move(content))
+        {
+        }
+
         virtual const char *data() const override { return content.c_str(); }
 
         virtual size_t size() const override { return content.size(); }
@@ -98,6 +107,16 @@ namespace alwf
         }
     };
 
+    // rapidjson output stream writing straight into a string, so serialized JSON needs no intermediate buffer
+    struct StringOutputStream
+    {
+        using Ch = char;
+        acul::string &out;
+
+        void Put(char c) { out.push_back(c); }
+        void Flush() {}
+    };
+
     class JSONResponse final : public IResponse
     {
     public:
@@ -105,10 +124,9 @@ namespace alwf
 
         JSONResponse(rapidjson::Document &&d, const char *content_type = "application/json") : IResponse(content_type)
         {
-            rapidjson::StringBuffer buf;
-            rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+            StringOutputStream os{json};
+            rapidjson::Writer<StringOutputStream> w(os);
             d.Accept(w);
-            json.assign(buf.GetString(), buf.GetSize());
         }
 
         JSONResponse(const acul::string &json, const char *content_type = "application/json")
@@ -116,6 +134,11 @@ namespace alwf
         {
         }
 
+        JSONResponse(acul::string &&json, const char *content_type = "application/json")
+            : IResponse(content_type), json(std::move(json))
+        {
+        }
+
         const char *data() const override { return json.c_str(); }
         size_t size() const override { return json.size(); }
     };
@@ -123,6 +146,13 @@ namespace alwf
     using EventHandler = std::function<void(const rapidjson::Value &)>;
     using RouteHandler = std::function<IResponse *(const Request &)>;
 
+    // Result sharing for a GET route, see Router::cache
+    struct RouteCachePolicy
+    {
+        u32 ttl_ms = 1000;    // 0: only coalesce identical requests while one is in flight
+        u32 max_entries = 32; // distinct queries kept per route
+    };
+
     struct Router
     {
         using route_store = acul::hashmap<acul::string, RouteHandler>;
@@ -131,10 +161,32 @@ namespace alwf
         route_store post;
         route_store put;
         route_store del;
+
+        // Null-terminated static file lists of GET pages (templates/<view>_assets.hpp). They are loaded into the
+        // file cache when the page is requested and advertised to the web view as preload hints.
+        acul::hashmap<acul::string, const char *const *> assets;
+
+        // GET routes whose results are shared. A result is kept for ttl_ms per path and normalized query, and
+        // identical requests arriving while a coroutine route computes it wait for that result instead of running the
+        // handler again.
+        acul::hashmap<acul::string, RouteCachePolicy> cache;
     };
 
     using HandlerRouter = acul::hashmap<acul::string, EventHandler>;
 
+    // Pending reply to an alwf.call() from the frontend. Can be copied and completed later from any thread.
+    struct Call
+    {
+        u64 id = 0;
+
+        bool resolve(const rapidjson::Value &result) const;
+        bool reject(const char *error) const;
+        bool cancelled() const;
+    };
+
+    using CallHandler = std::function<void(const rapidjson::Value &, Call)>;
+    using CallRouter = acul::hashmap<acul::string, CallHandler>;
+
     struct AlwfWindowFlagBits
     {
         enum enum_type : uint32_t
@@ -147,6 +199,24 @@ namespace alwf
     };
     using AlwfWindowFlags = acul::flags<AlwfWindowFlagBits>;
 
+    // Windows share one web context (and so one web process pool), the routers and every cache. init() opens
+    // main_window; closing it closes the others and ends run().
+    using WindowId = u32;
+    inline constexpr WindowId all_windows = 0;
+    inline constexpr WindowId main_window = 1;
+
+    struct WindowOptions
+    {
+        const char *title = "Alwf App";
+        int width = 800;
+        int height = 600;
+        AlwfWindowFlags flags =
+            AlwfWindowFlagBits::decorated | AlwfWindowFlagBits::resizable | AlwfWindowFlagBits::minimize_box;
+        const char *path = "/"; // page loaded into the window
+    };
+
+    struct StringTable;
+
     struct Options
     {
         // Window
@@ -161,9 +231,23 @@ namespace alwf
         size_t language_count = 0;
         const char *gettext_domain = "app";
         const char *locales_dir = "locales";
+        const StringTable *strings = nullptr; // templates/strings.hpp: alwf::strings::table
 
         // Log
         const char *log_file = nullptr;
+        // Access log of app scheme requests: route, method, status, latency and size, buffered in a ring and written by a
+        // background thread. Errors are always written, other requests 1 in access_log_sample. Records that do not
+        // fit in access_log_capacity between writes are dropped and counted; dropped errors go to the app log instead.
+        // Past access_log_max_bytes the file is rotated to <file>.1; 0 disables rotation. If the file cannot be
+        // opened, the access log stays off.
+        const char *access_log_file = nullptr;
+        u32 access_log_sample = 1;
+        u32 access_log_capacity = 4096;
+        size_t access_log_max_bytes = 16 << 20;
+        // Binary recording of requests and messages in both directions, replayable with alwf_replay
+        const char *capture_file = nullptr;
+        // Chrome trace-event JSON of the startup phases, from process start to the first paint of the page
+        const char *trace_file = nullptr;
 
         // Static files
         const char *static_folder = nullptr;
@@ -171,11 +255,108 @@ namespace alwf
         // Navigation
         Router *router = nullptr;
         HandlerRouter *handler_router = nullptr;
+        CallRouter *call_router = nullptr;
+        u32 call_timeout_ms = 30000;
+
+        // Blobs
+        u32 blob_ttl_ms = 60000;
+
+        // Prerendering
+        bool prerender_links = false;
+        size_t prerender_budget = 4 << 20;
+        u32 prerender_ttl_ms = 15000;
+
+        // Memory pressure: on system low-memory signals and while the window is minimized, the static file cache is
+        // trimmed to memory_low_water bytes, rendered-page caches are dropped and the web view is asked to release
+        // memory. web_memory_limit_mb caps the WebKitGTK web process; 0 keeps WebKit's default.
+        size_t memory_low_water = 1 << 20;
+        u32 web_memory_limit_mb = 0;
+
+        // Loopback HTTP transport for load testing and CI; 0 disables it. POST /__alwf/message feeds handler_router.
+        // Release builds only include it with the ALWF_HTTP_TRANSPORT CMake option. Clients must send Host
+        // 127.0.0.1:<port> or localhost:<port>, no foreign Origin, and http_token in the X-Alwf-Token header or the
+        // alwf_token query parameter. A null token is generated per launch and logged at startup.
+        u16 http_port = 0;
+        u32 http_threads = 0; // 0: one per core
+        const char *http_token = nullptr;
+
+        // Worker processes for worker_route() and worker_handler() jobs (alwf/worker.hpp); 0 disables them. They run
+        // this executable with ALWF_WORKER set, so main() must call serve_worker() first. A job running longer than
+        // worker_timeout_ms fails and its worker is restarted; 0 waits indefinitely.
+        u32 worker_processes = 0;
+        u32 worker_timeout_ms = 30000;
+
+        // Main-loop watchdog: stalls longer than this are logged with the route or handler running at the time and
+        // counted in collect_stalls(); 0 disables it
+        u32 stall_threshold_ms = 0;
+        bool stall_stack_samples = false; // also log the main thread's stack (Linux, Windows x64)
     };
 
     void init(const Options &opt);
     void run();
     void close_window();
     void shutdown();
+
+    // Main thread only
+    WindowId open_window(const WindowOptions &opt);
+    void close_window(WindowId id);
+    // The window whose message, call or page request is being handled; main_window outside of dispatch.
+    // Main thread only.
+    WindowId current_window();
+
+    // Sends to every window
     void send_json_to_frontend(const rapidjson::Value &json);
+    void send_json_to_window(WindowId id, const rapidjson::Value &json);
+    // Streams the message over the pages' push channels, falling back to send_json_to_frontend() for windows without
+    // one. Returns false when any target window was not streamed to and gets the slower fallback instead; the message
+    // is still delivered. Thread-safe.
+    bool push_to_frontend(const rapidjson::Value &json);
+    bool push_to_window(WindowId id, const rapidjson::Value &json);
+    bool resolve_call(u64 id, const rapidjson::Value &result);
+    bool reject_call(u64 id, const char *error);
+
+    using BlobId = u64;
+
+    // Registers a buffer servable at app:///__blob/<id>. It is released after `deliveries` fetches,
+    // on release_blob() or when Options::blob_ttl_ms passes without delivery. Thread-safe.
+    BlobId register_blob(acul::vector<char> &&data, const char *content_type = "application/octet-stream",
+                         u32 deliveries = 1);
+    void release_blob(BlobId id);
+    // A blob sent to all_windows is fetched once per window; register it with enough deliveries.
+    void send_blob_to_frontend(const char *handler, BlobId id, WindowId window = all_windows);
+
+    // Renders a GET route while the main loop is idle so the next navigation to it is served from memory.
+    // Renders run without request headers and are bounded by Options::prerender_budget. Thread-safe.
+    void prerender_route(const char *path);
+    // Drops prerendered pages, e.g. after a state change they depend on. Thread-safe.
+    void invalidate_prerendered();
+    // Drops the route's Router::cache results, or every route's when path is null. Requests already computing a
+    // result still share it but do not cache it. Main thread only.
+    void invalidate_route_cache(const char *path = nullptr);
+
+    // Bytes held by alwf subsystems
+    struct MemoryUsage
+    {
+        size_t static_cache;    // FileCache
+        size_t prerender_cache; // idle-time rendered pages
+        size_t route_cache;     // route results kept by Router::cache
+        size_t view_caches;     // registered memory consumers, e.g. ViewCache
+        size_t blobs;           // registered blobs awaiting delivery
+        size_t push_pending;    // outbound messages buffered in the push channel
+    };
+
+    // Caches outside the core that report their size and are dropped on memory pressure. Callbacks run on the
+    // main thread.
+    struct MemoryConsumer
+    {
+        std::function<size_t()> usage;
+        std::function<void()> trim;
+    };
+
+    u64 add_memory_consumer(MemoryConsumer &&consumer);
+    void remove_memory_consumer(u64 id);
+    // Main thread only
+    MemoryUsage memory_usage();
+    // Sheds caches as on a low-memory signal. Main thread only.
+    void trim_memory();
 } // namespace alwf
\ No newline at end of file
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <alwf/alwf.hpp>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+
+namespace alwf
+{
+    template <typename T = void>
+    class Task;
+
+    namespace detail
+    {
+        // Both resume inside a WindowScope of the window the coroutine suspended in. resume_after() reads it from
+        // current_window(), so it must be called on the main thread; resume_on_main() may be called from any thread.
+        void resume_on_main(std::coroutine_handle<> h, WindowId window);
+        void resume_after(std::coroutine_handle<> h, u32 ms);
+        // Runs the job on alwf's background pool
+        void run_in_background(std::function<void()> &&job);
+
+        struct PromiseBase
+        {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr error;
+
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+
+                template <typename P>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+                {
+                    auto next = h.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+            void unhandled_exception() noexcept { error = std::current_exception(); }
+        };
+
+        template <typename T>
+        struct ResultSlot
+        {
+            std::optional<T> value;
+
+            template <typename U>
+            void return_value(U &&v)
+            {
+                value.emplace(std::forward<U>(v));
+            }
+
+            T take() { return std::move(*value); }
+        };
+
+        template <>
+        struct ResultSlot<void>
+        {
+            void return_void() const noexcept {}
+            void take() const noexcept {}
+        };
+
+        // Self-destroying coroutine that drives a Task to completion
+        struct Detached
+        {
+            struct promise_type
+            {
+                Detached get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+        };
+
+        template <typename T, typename F>
+        Detached drive(Task<T> task, F done)
+        {
+            std::exception_ptr error;
+            if constexpr (std::is_void_v<T>)
+            {
+                try
+                {
+                    co_await task;
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                done(error);
+            }
+            else
+            {
+                std::optional<T> value;
+                try
+                {
+                    value.emplace(co_await task);
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                done(value ? std::move(*value) : T{}, error);
+            }
+        }
+    } // namespace detail
+
+    // Lazily started coroutine. co_await it from another coroutine, or hand it to spawn(). Every suspension point
+    // alwf provides resumes on the main thread, so handlers can touch the caches and routers as usual, and with
+    // current_window() restored to the window the handler was suspended in.
+    template <typename T>
+    class [[nodiscard]] Task
+    {
+    public:
+        struct promise_type : detail::PromiseBase, detail::ResultSlot<T>
+        {
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        };
+
+        Task(Task &&other) noexcept : _h(other._h) { other._h = nullptr; }
+        Task &operator=(Task &&) = delete;
+        ~Task()
+        {
+            if (_h) _h.destroy();
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+        {
+            _h.promise().continuation = caller;
+            return _h;
+        }
+
+        T await_resume()
+        {
+            if (_h.promise().error) std::rethrow_exception(_h.promise().error);
+            return _h.promise().take();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> _h;
+
+        explicit Task(std::coroutine_handle<promise_type> h) : _h(h) {}
+    };
+
+    // Runs the task to completion without waiting for it; an escaping exception is logged. Main thread only.
+    void spawn(Task<> task);
+
+    // Resumes the coroutine on the main thread after ms milliseconds
+    struct SleepAwaiter
+    {
+        u32 ms;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) const { detail::resume_after(h, ms); }
+        void await_resume() const noexcept {}
+    };
+
+    inline SleepAwaiter sleep_for(u32 ms) { return {ms}; }
+
+    // Runs fn on the background pool and resumes the coroutine on the main thread with its result. Exceptions are
+    // rethrown at the co_await.
+    template <typename F>
+    struct BackgroundAwaiter
+    {
+        using result_type = std::invoke_result_t<F &>;
+
+        F fn;
+        std::conditional_t<std::is_void_v<result_type>, bool, std::optional<result_type>> result{};
+        std::exception_ptr error;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            detail::run_in_background([this, h, window = current_window()]() {
+                try
+                {
+                    if constexpr (std::is_void_v<result_type>) fn();
+                    else result.emplace(fn());
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                detail::resume_on_main(h, window);
+            });
+        }
+
+        result_type await_resume()
+        {
+            if (error) std::rethrow_exception(error);
+            if constexpr (!std::is_void_v<result_type>) return std::move(*result);
+        }
+    };
+
+    template <typename F>
+    BackgroundAwaiter<std::decay_t<F>> background(F &&fn)
+    {
+        return {std::forward<F>(fn)};
+    }
+
+    // Reads a whole file on the background pool; throws std::runtime_error when it cannot be read
+    Task<acul::vector<char>> read_file(acul::string path);
+
+    // Route and message handlers written as coroutines. The request and message are copied into the coroutine, so
+    // they stay valid across suspension points. A suspended route holds no thread: its scheme request is answered
+    // when the coroutine returns.
+    using AsyncRouteHandler = std::function<Task<IResponse *>(Request)>;
+    using AsyncEventHandler = std::function<Task<>(rapidjson::Document)>;
+
+    RouteHandler async_route(AsyncRouteHandler handler);
+    EventHandler async_handler(AsyncEventHandler handler);
+} // namespace alwf
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <alwf/alwf.hpp>
+
+namespace alwf
+{
+    // Translations compiled from the .po files under ALFW_LOCALES_SRC into templates/strings.hpp.
+    // Rows are indexed by language, columns by the generated alwf::strings enumerators.
+    struct StringTable
+    {
+        const char *const *languages;
+        u32 language_count;
+        const char *const *msgids;
+        u32 count;
+        const char *const *rows;
+
+        const char *get(u32 language, u32 id) const { return rows[language * count + id]; }
+
+        // Matches "ru", "ru_RU" or "ru-RU.UTF-8" against the table's languages, falling back to the first one
+        u32 find_language(const acul::string &code) const;
+
+        // Linear search for msgids only known at runtime. Returns the msgid itself when it is not in the table.
+        const char *lookup(u32 language, const char *msgid) const;
+    };
+
+    // Default language used by tr(). Switching takes effect on the next render. Thread-safe.
+    void set_language(u32 language);
+
+    // Language of a single window, used while its messages and requests are handled instead of the default.
+    // Main thread only. Dropped when the window closes.
+    void set_window_language(WindowId window, u32 language);
+
+    // The language tr() renders in on this thread: a LanguageScope, then the current window's, then the default.
+    // Caches of rendered output (ViewCache, prerendered pages, Router::cache) are keyed on it.
+    u32 current_language();
+
+    // Renders in `language` on this thread until the scope ends, e.g. for a request that carries its own language
+    struct LanguageScope
+    {
+        u32 prev;
+
+        explicit LanguageScope(u32 language);
+        ~LanguageScope();
+    };
+
+    // Translates through Options::strings in the current language
+    const char *tr(u32 id);
+} // namespace alwf
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <alwf/alwf.hpp>
+
+namespace alwf
+{
+    enum class EndpointKind
+    {
+        route,
+        static_file,
+        blob,
+        not_found,
+        batch,   // /__alwf/batch envelopes; each sub-request is also recorded under its own endpoint
+        handler, // on_js_message handlers, dispatched synchronously
+        call     // alwf.call() handlers, completed asynchronously
+    };
+
+    struct LatencySummary
+    {
+        u64 count;
+        u64 mean_us;
+        u64 p50_us;
+        u64 p90_us;
+        u64 p99_us;
+        u64 max_us;
+    };
+
+    // Counters of one route or handler since startup or the last reset_metrics(). Static files, blobs and unmatched
+    // requests are aggregated into one endpoint each.
+    struct EndpointMetrics
+    {
+        EndpointKind kind;
+        acul::string name;  // "GET /path" for routes, the handler name for messages
+        u64 errors;         // error responses, throwing handlers, rejected and expired calls
+        u64 bytes;          // response bytes; message bytes for handlers, reply bytes for calls
+        u64 cache_hits;     // file cache for static files; prerender and Router::cache for routes, including
+                            // requests that joined an identical route in flight
+        u64 cache_misses;
+        u64 stalls;         // watchdog stalls that began while this endpoint was running
+        u64 stall_ms;       // their total duration
+        LatencySummary latency;    // time spent on the main thread
+        LatencySummary completion; // calls and coroutine routes: time until the result was delivered
+    };
+
+    // Main-loop stalls seen by the watchdog (Options::stall_threshold_ms)
+    struct StallSummary
+    {
+        u64 count;
+        u64 unattributed; // stalls outside route, handler and static file dispatch
+        u64 total_ms;
+        u64 max_ms;
+    };
+
+    // Snapshot of every endpoint hit so far. Thread-safe.
+    acul::vector<EndpointMetrics> collect_metrics();
+    StallSummary collect_stalls();
+    // The snapshot as JSON, with sync/async dispatch totals and stalls.
+    // Debug builds also serve it at app:///__alwf/metrics.
+    acul::string metrics_json();
+    void reset_metrics();
+} // namespace alwf
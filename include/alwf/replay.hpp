@@ -0,0 +1,10 @@
+#pragma once
+
+#include <alwf/alwf.hpp>
+
+namespace alwf
+{
+    // Implemented by the application in one of ALWF_REPLAY_SOURCES for the alwf_replay tool. Fills the router,
+    // handlers and static folder a capture is replayed against, as the application does before init().
+    void replay_setup(Options &opt);
+} // namespace alwf
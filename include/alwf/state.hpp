@@ -0,0 +1,43 @@
+#pragma once
+
+#include <alwf/alwf.hpp>
+#include <mutex>
+
+namespace alwf
+{
+    // Keyed JSON tree mirrored to alwf.state(name) in the page. Mutations are diffed against the current tree and
+    // sent as versioned JSON-Patch operations, coalesced until the next main loop iteration. Paths are JSON Pointers.
+    class StateStore
+    {
+    public:
+        explicit StateStore(const char *name = "default");
+        ~StateStore();
+
+        StateStore(const StateStore &) = delete;
+        StateStore &operator=(const StateStore &) = delete;
+
+        bool set(const char *path, const rapidjson::Value &value);
+        bool remove(const char *path);
+        bool get(const char *path, rapidjson::Document &out) const;
+
+        void flush();
+        // Sends the whole tree to the window, or to every window
+        void sync(WindowId window = all_windows);
+
+        u64 version() const;
+        const acul::string &name() const { return _name; }
+
+    private:
+        acul::string _name;
+        mutable std::mutex _lock;
+        rapidjson::Document _doc;
+        rapidjson::Document _ops;
+        u64 _version = 0;
+        bool _flush_pending = false;
+
+        bool write_ops(rapidjson::StringBuffer &buf);
+        void add_op(const char *op, const acul::string &path, const rapidjson::Value *value);
+        void diff(const acul::string &path, const rapidjson::Value &from, const rapidjson::Value &to);
+        void schedule_flush();
+    };
+} // namespace alwf
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <alwf/alwf.hpp>
+#include <alwf/l10n.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace alwf
+{
+    class SharedTextResponse final : public IResponse
+    {
+    public:
+        std::shared_ptr<const acul::string> content;
+
+        SharedTextResponse(std::shared_ptr<const acul::string> content, const char *content_type = "text/html")
+            : IResponse(content_type), content(std::move(content))
+        {
+        }
+
+        virtual const char *data() const override { return content->c_str(); }
+        virtual size_t size() const override { return content->size(); }
+    };
+
+    // Serves a view prerendered at build time (see ALWF_STATIC_VIEWS):
+    //     router.get["/"] = alwf::static_view(ahtt::start::prerendered::data, ahtt::start::prerendered::size);
+    // There is one rendering for every language, so localized views have to be rendered at runtime (ViewCache).
+    inline RouteHandler static_view(const char *data, size_t size, const char *content_type = "text/html")
+    {
+        return [=](const Request &) -> IResponse * { return acul::alloc<BinaryViewResponse>(data, size, content_type); };
+    }
+
+    // Memoizes the output of a view's render() keyed on its arguments and current_language(). Entries beyond
+    // `capacity` are evicted least recently used first. Dropped by alwf::trim_memory(). Thread-safe.
+    template <typename... Args>
+    class ViewCache
+    {
+    public:
+        using RenderFn = acul::string (*)(Args...);
+        using Key = std::tuple<u32, std::decay_t<Args>...>;
+
+        explicit ViewCache(RenderFn render, size_t capacity = 32, const char *content_type = "text/html")
+            : _render(render), _capacity(capacity ? capacity : 1), _content_type(content_type)
+        {
+            _consumer = add_memory_consumer({[this] { return bytes(); }, [this] { clear(); }});
+        }
+
+        ~ViewCache() { remove_memory_consumer(_consumer); }
+
+        ViewCache(const ViewCache &) = delete;
+        ViewCache &operator=(const ViewCache &) = delete;
+
+        IResponse *operator()(const std::decay_t<Args> &...args)
+        {
+            Key key{current_language(), args...};
+            {
+                std::lock_guard<std::mutex> lock(_lock);
+                if (auto it = _entries.find(key); it != _entries.end())
+                {
+                    it->second.last_used = ++_tick;
+                    return acul::alloc<SharedTextResponse>(it->second.content, _content_type);
+                }
+            }
+
+            auto content = std::make_shared<const acul::string>(_render(args...));
+            std::lock_guard<std::mutex> lock(_lock);
+            if (_entries.size() >= _capacity) evict();
+            _entries[std::move(key)] = Entry{content, ++_tick};
+            return acul::alloc<SharedTextResponse>(std::move(content), _content_type);
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _entries.clear();
+        }
+
+        size_t bytes()
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            size_t total = 0;
+            for (auto &[key, entry] : _entries) total += entry.content->size();
+            return total;
+        }
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<const acul::string> content;
+            u64 last_used;
+        };
+
+        RenderFn _render;
+        size_t _capacity;
+        const char *_content_type;
+        std::mutex _lock;
+        std::map<Key, Entry> _entries;
+        u64 _tick = 0;
+        u64 _consumer;
+
+        void evict()
+        {
+            auto victim = _entries.begin();
+            for (auto it = _entries.begin(); it != _entries.end(); ++it)
+                if (it->second.last_used < victim->second.last_used) victim = it;
+            if (victim != _entries.end()) _entries.erase(victim);
+        }
+    };
+} // namespace alwf
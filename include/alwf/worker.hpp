@@ -0,0 +1,65 @@
+#pragma once
+
+#include <alwf/async.hpp>
+#include <stdexcept>
+
+namespace alwf
+{
+    // Jobs a worker process can run, by name. A route job gets the forwarded request; a message job gets the message
+    // JSON as the request body. Jobs run synchronously, one at a time per process.
+    using WorkerRouter = acul::hashmap<acul::string, RouteHandler>;
+
+    // Call first thing in main(). In a process started by the worker pool (Options::worker_processes) it serves jobs
+    // until the UI process goes away and returns true, and the app should then exit. Returns false otherwise.
+    bool serve_worker(const WorkerRouter &jobs);
+
+    namespace detail
+    {
+        struct WorkerJob
+        {
+            acul::string frame; // the encoded request, built on the main thread
+            IResponse *res = nullptr;
+            acul::string error;
+            std::coroutine_handle<> caller;
+            WindowId window = main_window; // the caller is resumed in
+        };
+
+        void encode_worker_job(WorkerJob &job, const char *name, const Request &req);
+        // Queues the job and resumes job->caller on the main thread once it is done. False, with job->error set,
+        // when no pool is running.
+        bool submit_worker_job(WorkerJob *job);
+    } // namespace detail
+
+    // Runs the job in a worker process and resumes on the main thread with its response. Accept, Content-Type and
+    // X-Requested-With are forwarded; requests parsed by alwf forward all their headers. Throws std::runtime_error
+    // when the job fails, or when its worker crashes or runs past Options::worker_timeout_ms and is restarted.
+    class WorkerAwaiter
+    {
+    public:
+        WorkerAwaiter(const char *name, const Request &req) { detail::encode_worker_job(_job, name, req); }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            _job.caller = h;
+            _job.window = current_window();
+            return detail::submit_worker_job(&_job);
+        }
+
+        IResponse *await_resume()
+        {
+            if (!_job.error.empty()) throw std::runtime_error(_job.error.c_str());
+            return _job.res;
+        }
+
+    private:
+        detail::WorkerJob _job;
+    };
+
+    inline WorkerAwaiter run_in_worker(const char *name, const Request &req) { return {name, req}; }
+
+    // A route or message handler bound to a job of the worker processes
+    RouteHandler worker_route(const char *name);
+    EventHandler worker_handler(const char *name);
+} // namespace alwf
@@ -2,13 +2,16 @@
 #include <acul/log.hpp>
 #include <acul/task.hpp>
 #include <alwf/alwf.hpp>
+#include <alwf/l10n.hpp>
 #include "internal/framework.hpp"
 
 namespace alwf
 {
     static struct Runtime
     {
-        PLATFORM_WINDOW *window = nullptr;
+        acul::hashmap<WindowId, PLATFORM_WINDOW *> windows;
+        WindowId next_window = main_window;
+        std::atomic<size_t> window_count{0};
 #ifdef _WIN32
         acul::events::dispatcher ed;
 #endif
@@ -20,7 +23,11 @@ namespace alwf
     {
         if (!opt.languages) return;
         if (opt.language_count > 0)
-            acul::locales::setup_i18n(acul::locales::get_user_language(opt.languages, opt.language_count));
+        {
+            auto language = acul::locales::get_user_language(opt.languages, opt.language_count);
+            acul::locales::setup_i18n(language);
+            if (opt.strings) set_language(opt.strings->find_language(language));
+        }
         bindtextdomain(opt.gettext_domain, opt.locales_dir);
         bind_textdomain_codeset(opt.gettext_domain, "UTF-8");
         textdomain(opt.gettext_domain);
@@ -44,7 +51,7 @@ namespace alwf
     }
 #endif
 
-    static PLATFORM_WINDOW *init_window(const Options &opt)
+    static void init_window_system()
     {
 #ifdef _WIN32
         awin::InitConfig cfg;
@@ -52,27 +59,120 @@ namespace alwf
         cfg.log_service = rt->logsvc;
         cfg.logger = acul::log::get_default_logger();
         awin::init_library(cfg);
-        awin::WindowFlags flags = map_win_flags(opt.flags);
-        static awin::Window window{opt.title, opt.width, opt.height, flags};
-        rt->window = &window;
 
         rt->ed.bind_event(rt, awin::event_id::resize,
                           [=](const awin::PosEvent &e) { on_resize(e.window, e.position); });
-        rt->ed.bind_event(rt, awin::event_id::move, [=](const awin::PosEvent &e) { on_move(); });
-        awin::update_events();
+        rt->ed.bind_event(rt, awin::event_id::move, [=](const awin::PosEvent &e) { on_move(e.window); });
 #else
         gtk_init(nullptr, nullptr);
+#endif
+    }
+
+    static PLATFORM_WINDOW *create_window(const WindowOptions &opt)
+    {
+#ifdef _WIN32
+        awin::WindowFlags flags = map_win_flags(opt.flags);
+        auto *window = acul::alloc<awin::Window>(opt.title, opt.width, opt.height, flags);
+        awin::update_events();
+        return window;
+#else
         GtkWidget *w = gtk_window_new(GTK_WINDOW_TOPLEVEL);
         gtk_window_set_default_size(GTK_WINDOW(w), opt.width, opt.height);
         gtk_window_set_title(GTK_WINDOW(w), opt.title);
         apply_gtk_flags(w, opt.flags);
-        rt->window = w;
+        return w;
+#endif
+    }
+
+    static PLATFORM_WINDOW *find_window(WindowId id)
+    {
+        auto it = rt->windows.find(id);
+        return it == rt->windows.end() ? nullptr : it->second;
+    }
+
+    // Drops a window whose native side is already gone
+    static void forget_window(WindowId id)
+    {
+        if (!rt->windows.erase(id)) return;
+        rt->window_count.fetch_sub(1, std::memory_order_relaxed);
+        destroy_web_view(id);
+        drop_window_calls(id);
+        forget_window_language(id);
+        on_window_visibility(id, true);
+    }
+
+#ifdef _WIN32
+    static void close_finished_windows()
+    {
+        acul::vector<WindowId> finished;
+        for (auto &[id, w] : rt->windows)
+            if (id != main_window && w->ready_to_close()) finished.push_back(id);
+        for (WindowId id : finished)
+        {
+            PLATFORM_WINDOW *w = find_window(id);
+            forget_window(id);
+            w->destroy();
+            acul::release(w);
+        }
+    }
+#endif
+
+    size_t window_count() { return rt ? rt->window_count.load(std::memory_order_relaxed) : 0; }
+
+    acul::vector<WindowId> window_ids()
+    {
+        acul::vector<WindowId> ids;
+        if (!rt) return ids;
+        ids.reserve(rt->windows.size());
+        for (auto &[id, w] : rt->windows) ids.push_back(id);
+        return ids;
+    }
+
+    WindowId open_window(const WindowOptions &opt)
+    {
+        assert(rt && ctx && "Alwf is not initialized");
+        const WindowId id = rt->next_window++;
+        PLATFORM_WINDOW *w = create_window(opt);
+        rt->windows.emplace(id, w);
+        rt->window_count.fetch_add(1, std::memory_order_relaxed);
+        init_web_view(id, w, opt.path);
+#ifndef _WIN32
+        // The main window is shown by run(), and its destruction ends the main loop
+        if (id != main_window)
+        {
+            g_signal_connect(w, "destroy",
+                             G_CALLBACK(+[](GtkWidget *, gpointer data) { forget_window(GPOINTER_TO_UINT(data)); }),
+                             GUINT_TO_POINTER(id));
+            gtk_widget_show_all(w);
+        }
+#endif
+        return id;
+    }
+
+    void close_window(WindowId id)
+    {
+        if (id == main_window) return close_window();
+        PLATFORM_WINDOW *w = find_window(id);
+        if (!w) return;
+#ifdef _WIN32
+        w->ready_to_close(true); // reaped by run() after the current event
+#else
+        gtk_widget_destroy(w);
 #endif
-        return rt->window;
     }
 
     void init(const Options &opt)
     {
+        // A pool worker whose main() skipped serve_worker() would open a window and start workers of its own.
+        // It exits before touching the log file it shares with the UI process.
+        if (getenv("ALWF_WORKER"))
+        {
+            fprintf(stderr, "alwf: worker process reached init(); call alwf::serve_worker() first in main()\n");
+            exit(1);
+        }
+        if (opt.trace_file) start_startup_trace(opt.trace_file);
+        TraceScope trace_init("init");
+        auto log_start = MetricsClock::now();
         rt = acul::alloc<Runtime>();
         rt->sd.run();
         rt->logsvc = acul::alloc<acul::log::log_service>();
@@ -95,20 +195,64 @@ namespace alwf
             logger->set_pattern("%(ascii_time) %(level_name) %(message)\n");
             acul::log::set_default_logger(logger);
         }
+        trace_span("log service", log_start);
+        if (opt.capture_file) start_capture(opt.capture_file);
+        if (opt.access_log_file && !start_access_log(opt.access_log_file, opt.access_log_capacity,
+                                                     opt.access_log_sample, opt.access_log_max_bytes))
+            LOG_WARN("Access log is disabled; request errors go to the app log");
 
         ctx = acul::alloc<Context>();
         ctx->router = opt.router;
         ctx->handler_router = opt.handler_router;
+        ctx->call_router = opt.call_router;
+        ctx->strings = opt.strings;
+        ctx->call_timeout_ms = opt.call_timeout_ms;
+        ctx->blob_ttl_ms = opt.blob_ttl_ms;
+        ctx->prerender_links = opt.prerender_links;
+        ctx->prerender_budget = opt.prerender_budget;
+        ctx->prerender_ttl_ms = opt.prerender_ttl_ms;
+        ctx->memory_low_water = opt.memory_low_water;
+        ctx->web_memory_limit_mb = opt.web_memory_limit_mb;
         ctx->static_folder = opt.static_folder;
 
+        // The start page's assets are read from disk while the window and the web view are created
+        if (opt.router) prewarm_page_assets("/");
+
+        // i18n stays ahead of the window: gtk_init() calls setlocale(), which must see the selected language
         LOG_INFO("Setup i18n");
-        setup_i18n(opt);
+        {
+            TraceScope trace("i18n");
+            setup_i18n(opt);
+        }
 
         LOG_INFO("Init window");
-        PLATFORM_WINDOW *w = init_window(opt);
+        {
+            TraceScope trace("window");
+            init_window_system();
+        }
 
         LOG_INFO("Init web view");
-        init_web_view(w);
+        {
+            TraceScope trace("web view");
+            WindowOptions main;
+            main.title = opt.title;
+            main.width = opt.width;
+            main.height = opt.height;
+            main.flags = opt.flags;
+            open_window(main);
+        }
+
+        if (opt.http_port)
+        {
+            TraceScope trace("http transport");
+            start_http_transport(opt.http_port, opt.http_threads, opt.http_token);
+        }
+        if (opt.worker_processes)
+        {
+            TraceScope trace("worker pool");
+            start_worker_pool(opt.worker_processes, opt.worker_timeout_ms);
+        }
+        start_watchdog(opt.stall_threshold_ms, opt.stall_stack_samples);
 
         LOG_INFO("Alwf inited successfully");
     }
@@ -116,13 +260,19 @@ namespace alwf
     void run()
     {
         LOG_INFO("Run main loop");
+        trace_instant("main loop");
+        PLATFORM_WINDOW *w = find_window(main_window);
 #ifdef _WIN32
-        PLATFORM_WINDOW *w = rt->window;
-        while (w && !w->ready_to_close()) awin::wait_events();
-        if (w) w->destroy();
+        while (w && !w->ready_to_close())
+        {
+            awin::wait_events();
+            dispatch_main_queue();
+            close_finished_windows();
+        }
+        for (auto &[id, window] : rt->windows) window->destroy();
 #else
-        g_signal_connect(rt->window, "destroy", G_CALLBACK(gtk_main_quit), nullptr);
-        gtk_widget_show_all(rt->window);
+        g_signal_connect(w, "destroy", G_CALLBACK(gtk_main_quit), nullptr);
+        gtk_widget_show_all(w);
         gtk_main();
 #endif
     }
@@ -130,7 +280,7 @@ namespace alwf
     void close_window()
     {
 #ifdef _WIN32
-        PLATFORM_WINDOW *w = rt->window;
+        PLATFORM_WINDOW *w = find_window(main_window);
         if (w) w->ready_to_close(true);
 #else
         gtk_main_quit();
@@ -140,33 +290,25 @@ namespace alwf
     void shutdown()
     {
         LOG_INFO("Shutdown alwf");
+        finish_startup_trace();
+        stop_watchdog();
+        stop_http_transport();
+        stop_worker_pool();
+        stop_background_pool();
+        stop_access_log();
+        stop_capture();
+        destroy_push_channel();
         destroy_platform();
+        destroy_blobs();
+        destroy_prerender_cache();
+        destroy_route_cache();
+        destroy_page_assets();
 #ifdef _WIN32
+        for (auto &[id, w] : rt->windows) acul::release(w);
         awin::destroy_library();
 #endif
         acul::release(rt);
         acul::release(ctx);
         ctx = nullptr;
     }
-
-    void parse_request_url(const acul::string &uri, Request &request)
-    {
-        acul::string path;
-        acul::string query;
-
-        if (auto qpos = uri.find('?'); qpos != acul::string::npos)
-        {
-            path = uri.substr(0, qpos);
-            query = uri.substr(qpos + 1);
-        }
-        else
-        {
-            path = uri;
-            query = "";
-        }
-
-        request.path = std::move(path);
-        request.query = std::move(query);
-    }
-
 } // namespace alwf
\ No newline at end of file
@@ -1,6 +1,12 @@
 // alwf.js
 (function (global) {
-  const listeners = new Map(); // name -> Set<fn>
+  const listeners = new Map(); // name -> Map<fn, handler>
+  const snapshots = new Map(); // name -> handler[], rebuilt only when listeners change
+  const raf = global.requestAnimationFrame ? (cb) => global.requestAnimationFrame(cb) : (cb) => setTimeout(cb, 16);
+  const cancelRaf = global.cancelAnimationFrame ? (id) => global.cancelAnimationFrame(id) : (id) => clearTimeout(id);
+  const calls = new Map(); // call id -> { resolve, reject, done }
+  const session = Math.random().toString(36).slice(2);
+  let callSeq = 0;
   let transport = null;
 
   function tryParse(x) { try { return typeof x === 'string' ? JSON.parse(x) : x; } catch { return x; } }
@@ -12,52 +18,403 @@
     const msg = tryParse(data);
     const k = keyOf(msg);
     if (!k) return;
-    const set = listeners.get(k);
-    if (set) for (const fn of [...set]) { try { fn(msg); } catch { } }
+    if (k === '__alwf_reply') { settle(msg); return; }
+    if (k === '__alwf_state') { applyState(msg); return; }
+    if (msg.__blob !== undefined) {
+      blob(msg.__blob).then((buf) => { msg.data = buf; deliver(k, msg); }, (e) => console.warn(e.message));
+      return;
+    }
+    deliver(k, msg);
+  }
+
+  function deliver(k, msg) {
+    let list = snapshots.get(k);
+    if (!list) {
+      const handlers = listeners.get(k);
+      if (!handlers) return;
+      list = [...handlers.values()];
+      snapshots.set(k, list);
+    }
+    for (const fn of list) { try { fn(msg); } catch { } }
+  }
+
+  // Buffers messages and hands them to fn at most once per animation frame:
+  // the latest message (keep: 'latest') or all of them as an array (keep: 'all').
+  // off() calls cancel() so a frame scheduled before it does not fire.
+  function coalesced(fn, keep) {
+    const all = keep === 'all';
+    let pending = all ? [] : undefined;
+    let frame = null;
+    const flush = () => {
+      frame = null;
+      const value = pending;
+      pending = all ? [] : undefined;
+      try { fn(value); } catch { }
+    };
+    const handler = (msg) => {
+      if (all) pending.push(msg); else pending = msg;
+      if (frame === null) frame = raf(flush);
+    };
+    handler.cancel = () => {
+      if (frame !== null) cancelRaf(frame);
+      frame = null;
+      pending = all ? [] : undefined;
+    };
+    return handler;
+  }
+
+  function blob(id) {
+    return fetch(`/__blob/${id}`).then((r) => {
+      if (!r.ok) throw new Error(`alwf: blob ${id} is not available`);
+      return r.arrayBuffer();
+    });
+  }
+
+  // Long-lived push channel: newline-delimited JSON frames over a single app:// request
+  function openStream(retry = 1000) {
+    if (!global.fetch || !global.TextDecoder || !global.ReadableStream) return;
+    const reopen = (delay) => setTimeout(() => openStream(Math.min(delay * 2, 30000)), delay);
+    fetch('/__alwf/stream', { cache: 'no-store' }).then(async (r) => {
+      if (!r.ok || !r.body) return;
+      const reader = r.body.getReader();
+      const decoder = new TextDecoder();
+      let buf = '';
+      let live = false;
+      for (; ;) {
+        const { value, done } = await reader.read();
+        if (done) break;
+        live = true;
+        buf += decoder.decode(value, { stream: true });
+        let nl;
+        while ((nl = buf.indexOf('\n')) >= 0) {
+          const line = buf.slice(0, nl);
+          buf = buf.slice(nl + 1);
+          if (line) dispatch(line);
+        }
+      }
+      // Closed by the backend; without a stream pushes fall back to the web view. One that carried frames was
+      // healthy, so the backoff starts over.
+      reopen(live ? 1000 : retry);
+    }).catch(() => reopen(retry));
   }
 
   (function detect() {
     if (global.chrome?.webview?.postMessage) {
       transport = (m) => { global.chrome.webview.postMessage(m); return true; };
       global.chrome.webview.addEventListener('message', dispatch);
+      openStream();
       return;
     }
     if (global.webkit?.messageHandlers?.handler?.postMessage) {
       transport = (m) => { global.webkit.messageHandlers.handler.postMessage(serialize(m)); return true; };
       const prev = global.__alwf_receive;
       global.__alwf_receive = function (payload) { dispatch(payload); if (typeof prev === 'function') try { prev(payload); } catch { } };
+      openStream();
       return;
     }
     transport = () => { console.warn('alwf: no native bridge found'); return false; };
   })();
 
+  // Backend state stores (alwf::StateStore) mirrored through versioned JSON-Patch deltas
+  const stores = new Map(); // name -> { data, version, syncing, listeners: Map<path, Set<fn>> }
+
+  function parsePointer(path) {
+    return path ? path.slice(1).split('/').map((t) => t.replace(/~1/g, '/').replace(/~0/g, '~')) : [];
+  }
+
+  function lookup(root, path) {
+    let node = root;
+    for (const k of parsePointer(path)) {
+      if (node === null || typeof node !== 'object') return undefined;
+      node = node[k];
+    }
+    return node;
+  }
+
+  function applyOp(root, op) {
+    const keys = parsePointer(op.path);
+    if (!keys.length) return op.op === 'remove' ? {} : op.value;
+    let node = root;
+    for (const k of keys.slice(0, -1)) {
+      if (node[k] === null || typeof node[k] !== 'object') node[k] = {};
+      node = node[k];
+    }
+    const last = keys[keys.length - 1];
+    if (op.op === 'remove') {
+      if (Array.isArray(node)) node.splice(+last, 1); else delete node[last];
+    } else if (Array.isArray(node) && last === '-') node.push(op.value);
+    else node[last] = op.value;
+    return root;
+  }
+
+  function related(a, b) { return !a || !b || a === b || a.startsWith(b + '/') || b.startsWith(a + '/'); }
+
+  function storeOf(name) {
+    let s = stores.get(name);
+    if (!s) {
+      s = { data: {}, version: 0, syncing: false, listeners: new Map() };
+      stores.set(name, s);
+      requestSync(name, s);
+    }
+    return s;
+  }
+
+  function requestSync(name, s) {
+    if (s.syncing) return;
+    s.syncing = true;
+    emit('__alwf_state_sync', { store: name });
+  }
+
+  function notify(s, paths) {
+    for (const [path, set] of s.listeners) {
+      if (!paths.some((p) => related(p, path))) continue;
+      const value = lookup(s.data, path);
+      for (const fn of [...set]) { try { fn(value, path); } catch { } }
+    }
+  }
+
+  function applyState(msg) {
+    const s = storeOf(msg.store);
+    if (msg.snapshot !== undefined) {
+      s.data = msg.snapshot;
+      s.version = msg.version;
+      s.syncing = false;
+      notify(s, ['']);
+      return;
+    }
+    if (msg.version <= s.version) return;
+    if (msg.version !== s.version + 1) { requestSync(msg.store, s); return; }
+    s.version = msg.version;
+    for (const op of msg.ops) s.data = applyOp(s.data, op);
+    notify(s, msg.ops.map((op) => op.path));
+  }
+
+  function state(name = 'default') {
+    const s = storeOf(String(name));
+    return {
+      get version() { return s.version; },
+      get(path = '') { return lookup(s.data, path); },
+      on(path, fn) {
+        const k = String(path);
+        if (!s.listeners.has(k)) s.listeners.set(k, new Set());
+        const set = s.listeners.get(k);
+        set.add(fn);
+        return () => { set.delete(fn); if (!set.size) s.listeners.delete(k); };
+      },
+    };
+  }
+
+  // In-page navigation: internal links fetch only the target fragments and swap them into the document.
+  // Enabled with alwf.navigation(['#content', 'nav']) or <html data-alwf-navigate="#content,nav">.
+  let navTargets = null;
+
+  function navigation(targets) {
+    navTargets = (Array.isArray(targets) ? targets : String(targets).split(','))
+      .map((t) => t.trim()).filter(Boolean);
+    if (navigation.bound) return;
+    navigation.bound = true;
+    document.addEventListener('click', onNavigationClick);
+    global.addEventListener('popstate', (e) => { if (e.state?.alwf) navigate(location.pathname + location.search, false); });
+    history.replaceState({ alwf: true }, '');
+  }
+
+  function onNavigationClick(e) {
+    if (!navTargets?.length || e.defaultPrevented || e.button !== 0 || e.metaKey || e.ctrlKey || e.shiftKey || e.altKey) return;
+    const a = e.target.closest?.('a[href]');
+    if (!a || a.target || a.hasAttribute('download')) return;
+    const url = new URL(a.href, location.href);
+    if (url.origin !== location.origin || (url.pathname === location.pathname && url.hash)) return;
+    e.preventDefault();
+    navigate(url.pathname + url.search, true);
+  }
+
+  function loadScripts(sources) {
+    const loaded = new Set([...document.scripts].map((s) => s.src));
+    return sources.reduce((chain, src) => {
+      const href = new URL(src, location.href).href;
+      if (loaded.has(href)) return chain;
+      return chain.then(() => new Promise((resolve) => {
+        const el = document.createElement('script');
+        el.src = href;
+        el.onload = el.onerror = resolve;
+        document.head.appendChild(el);
+      }));
+    }, Promise.resolve());
+  }
+
+  async function navigate(href, push) {
+    try {
+      const r = await fetch(href, { headers: { 'X-Alwf-Fragment': navTargets.join(',') } });
+      if (!r.ok) throw new Error();
+      const page = await r.json();
+      const swaps = navTargets.map((sel) => [document.querySelector(sel), page.fragments?.[sel]]);
+      if (swaps.some(([el, html]) => !el || html === undefined)) throw new Error();
+
+      for (const [el, html] of swaps) {
+        const tpl = document.createElement('template');
+        tpl.innerHTML = html;
+        el.replaceWith(tpl.content);
+      }
+      if (page.title !== undefined) {
+        const t = document.createElement('textarea');
+        t.innerHTML = page.title;
+        document.title = t.value;
+      }
+      if (push) history.pushState({ alwf: true }, '', href);
+      global.scrollTo(0, 0);
+      await loadScripts(page.scripts ?? []);
+      document.dispatchEvent(new CustomEvent('alwf:navigate', { detail: { href } }));
+    } catch {
+      location.href = href;
+    }
+  }
+
+  if (document.documentElement?.dataset.alwfNavigate) navigation(document.documentElement.dataset.alwfNavigate);
+
+  // Ends the startup trace (Options::trace_file); the backend ignores it otherwise
+  (function reportFirstPaint() {
+    let sent = false;
+    const send = (at) => { if (!sent) { sent = true; emit('__alwf_first_paint', { at }); } };
+    try {
+      new PerformanceObserver((list) => { const e = list.getEntries()[0]; if (e) send(e.startTime); })
+        .observe({ type: 'paint', buffered: true });
+    } catch { }
+    requestAnimationFrame(() => setTimeout(() => send(performance.now()), 0));
+  })();
+
+  // Bodies fetch() sends as bytes or form data; a batch carries text only and JSON.stringify would turn them into "{}"
+  function isRawBody(body) {
+    return body instanceof Blob || body instanceof FormData || body instanceof URLSearchParams ||
+      body instanceof ArrayBuffer || ArrayBuffer.isView(body) ||
+      (global.ReadableStream !== undefined && body instanceof ReadableStream);
+  }
+
+  // Route requests multiplexed over one scheme round trip. Entries are paths or { path, method, query, body, headers };
+  // bodies are strings or JSON values. Resolves to one Response per entry, in order.
+  function batch(requests) {
+    const bad = requests.find((r) => typeof r === 'object' && isRawBody(r.body));
+    if (bad) {
+      return Promise.reject(new TypeError(`alwf: batch entry '${bad.path}' has a binary or form body; use fetch()`));
+    }
+    const list = requests.map((r) => {
+      const { path, method = 'GET', query, body, headers } = typeof r === 'string' ? { path: r } : r;
+      const q = path.indexOf('?');
+      const entry = { method: method.toUpperCase(), path: q < 0 ? path : path.slice(0, q) };
+      if (query !== undefined || q >= 0) entry.query = query ?? path.slice(q + 1);
+      if (body !== undefined && body !== null) entry.body = serialize(body);
+      if (headers) entry.headers = Object.fromEntries(new Headers(headers));
+      return entry;
+    });
+    return fetch('/__alwf/batch', { method: 'POST', body: JSON.stringify(list) }).then(async (r) => {
+      const bytes = new Uint8Array(await r.arrayBuffer());
+      const nl = bytes.indexOf(10);
+      if (nl < 0) throw new Error(`alwf: batch failed: ${new TextDecoder().decode(bytes)}`);
+      const frames = JSON.parse(new TextDecoder().decode(bytes.subarray(0, nl)));
+      let at = nl + 1;
+      return frames.map((f) => {
+        const body = bytes.slice(at, at += f.size);
+        return new Response(body, { status: f.status, headers: { 'Content-Type': f.type } });
+      });
+    });
+  }
+
+  // fetch() for app routes: requests made in the same task go out as one batch. Requests with a Blob, FormData,
+  // ArrayBuffer, typed array, URLSearchParams or stream body are never batched and go out through a plain fetch().
+  let queued = null;
+  function request(path, init = {}) {
+    if (isRawBody(init.body)) return fetch(path, init);
+    return new Promise((resolve, reject) => {
+      if (!queued) {
+        queued = [];
+        queueMicrotask(() => {
+          const list = queued;
+          queued = null;
+          if (list.length === 1) { fetch(list[0].path, list[0].init).then(list[0].resolve, list[0].reject); return; }
+          batch(list.map((e) => ({ path: e.path, ...e.init }))).then(
+            (rs) => list.forEach((e, i) => e.resolve(rs[i])), (err) => list.forEach((e) => e.reject(err)));
+        });
+      }
+      queued.push({ path, init, resolve, reject });
+    });
+  }
+
   // public API
   function ready() { return Promise.resolve(!!transport); }
 
-  function emit(name, payload) {
+  function message(name, payload) {
     const base = { handler: name, event: name, name };
-    const msg = (payload && typeof payload === 'object') ? { ...base, ...payload }
+    return (payload && typeof payload === 'object') ? { ...base, ...payload }
       : { ...base, message: payload };
-    return transport ? transport(msg) : false;
   }
 
-  function on(name, fn) {
+  function emit(name, payload) {
+    return transport ? transport(message(name, payload)) : false;
+  }
+
+  function settle(msg) {
+    const c = calls.get(msg.__call);
+    if (!c) return;
+    c.done();
+    if (msg.ok) c.resolve(msg.result);
+    else c.reject(new Error(msg.error ?? 'alwf: call failed'));
+  }
+
+  // opts: { timeout: ms (0 disables, default 30000), signal: AbortSignal }
+  function call(name, payload, opts = {}) {
+    const id = `${session}:${++callSeq}`;
+    return new Promise((resolve, reject) => {
+      const { timeout = 30000, signal } = opts;
+      let timer = 0;
+      const done = () => {
+        calls.delete(id);
+        if (timer) clearTimeout(timer);
+        if (signal) signal.removeEventListener('abort', abort);
+      };
+      const cancel = (err) => {
+        if (!calls.has(id)) return;
+        done();
+        if (transport) transport({ handler: '__alwf_cancel', __call: id });
+        reject(err);
+      };
+      const abort = () => cancel(signal.reason ?? new Error('alwf: call aborted'));
+
+      if (signal?.aborted) { reject(signal.reason ?? new Error('alwf: call aborted')); return; }
+      calls.set(id, { resolve, reject, done });
+      if (timeout > 0) timer = setTimeout(() => cancel(new Error(`alwf: call '${name}' timed out`)), timeout);
+      if (signal) signal.addEventListener('abort', abort, { once: true });
+      if (!transport || !transport({ ...message(name, payload), __call: id })) {
+        done();
+        reject(new Error('alwf: no native bridge found'));
+      }
+    });
+  }
+
+  // opts: { coalesce: 'frame', keep: 'latest' | 'all' }
+  function on(name, fn, opts) {
     const k = String(name);
-    if (!listeners.has(k)) listeners.set(k, new Set());
-    const set = listeners.get(k);
-    set.add(fn);
-    return () => { set.delete(fn); if (!set.size) listeners.delete(k); };
+    if (!listeners.has(k)) listeners.set(k, new Map());
+    const handlers = listeners.get(k);
+    handlers.get(fn)?.cancel?.();
+    handlers.set(fn, opts?.coalesce === 'frame' ? coalesced(fn, opts.keep) : fn);
+    snapshots.delete(k);
+    return () => off(k, fn);
   }
 
-  function once(name, fn) {
-    const off = on(name, (m) => { try { fn(m); } finally { off(); } });
-    return off;
+  function once(name, fn, opts) {
+    const wrapped = (m) => { try { fn(m); } finally { off(name, wrapped); } };
+    return on(name, wrapped, opts);
   }
 
   function off(name, fn) {
-    const set = listeners.get(String(name));
-    if (set) { set.delete(fn); if (!set.size) listeners.delete(name); }
+    const k = String(name);
+    const handlers = listeners.get(k);
+    const handler = handlers?.get(fn);
+    if (!handler) return;
+    handlers.delete(fn);
+    handler.cancel?.();
+    snapshots.delete(k);
+    if (!handlers.size) listeners.delete(k);
   }
 
-  global.alwf = { ready, emit, on, once, off };
+  global.alwf = { ready, emit, call, blob, batch, fetch: request, state, navigation, on, once, off };
 })(window);
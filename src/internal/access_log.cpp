@@ -0,0 +1,223 @@
+#include <acul/log.hpp>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include "framework.hpp"
+
+namespace alwf
+{
+    // Fixed-size record filled on the request path with copies only; formatting happens on the writer thread
+    struct AccessRecord
+    {
+        i64 time_ms; // wall clock
+        u32 latency_us;
+        u32 size;
+        u16 status;
+        Method method;
+        char path[128];
+        char error[128];
+    };
+
+    // Bounded MPMC queue slot (Vyukov): seq tells producers and the consumer whose turn the slot is
+    struct AccessSlot
+    {
+        std::atomic<u64> seq;
+        AccessRecord record;
+    };
+
+    static struct AccessLog
+    {
+        std::unique_ptr<AccessSlot[]> slots;
+        u64 mask;
+        std::atomic<u64> head{0};
+        u64 tail = 0; // writer thread only
+        std::atomic<u64> dropped{0};
+        std::atomic<u64> sampled{0};
+        u32 sample;
+        size_t max_bytes;
+        acul::string path;
+        FILE *file = nullptr;
+        size_t file_bytes = 0;
+        std::thread writer;
+        std::mutex lock;
+        std::condition_variable cv;
+        bool stop = false;
+    } *access_log = nullptr;
+
+    static std::atomic<bool> active{false};
+
+    bool access_log_active() { return active.load(std::memory_order_relaxed); }
+
+    static void copy_truncated(char (&dst)[128], const char *src, size_t len)
+    {
+        if (len >= sizeof(dst)) len = sizeof(dst) - 1;
+        memcpy(dst, src, len);
+        dst[len] = 0;
+    }
+
+    void log_access(const Request &req, u16 status, u64 latency_us, size_t size, const char *error)
+    {
+        if (!access_log_active()) return;
+        auto *log = access_log;
+        if (!error && log->sample > 1 && log->sampled.fetch_add(1, std::memory_order_relaxed) % log->sample != 0) return;
+
+        u64 pos = log->head.load(std::memory_order_relaxed);
+        AccessSlot *slot;
+        for (;;)
+        {
+            slot = &log->slots[pos & log->mask];
+            const i64 diff = (i64)slot->seq.load(std::memory_order_acquire) - (i64)pos;
+            if (diff == 0)
+            {
+                if (log->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0)
+            {
+                log->dropped.fetch_add(1, std::memory_order_relaxed);
+                // emit_error() left the error to this record, so it must not be lost with it
+                if (error) LOG_ERROR("%s", error);
+                return;
+            }
+            else pos = log->head.load(std::memory_order_relaxed);
+        }
+
+        AccessRecord &r = slot->record;
+        r.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+        r.latency_us = (u32)std::min<u64>(latency_us, UINT32_MAX);
+        r.size = (u32)std::min<size_t>(size, UINT32_MAX);
+        r.status = status;
+        r.method = req.method;
+        copy_truncated(r.path, req.path.c_str(), req.path.size());
+        if (error) copy_truncated(r.error, error, strlen(error));
+        else r.error[0] = 0;
+        slot->seq.store(pos + 1, std::memory_order_release);
+    }
+
+    static void open_log_file()
+    {
+        access_log->file = fopen(access_log->path.c_str(), "ab");
+        if (!access_log->file)
+        {
+            LOG_ERROR("Failed to open access log: %s", access_log->path.c_str());
+            return;
+        }
+        fseek(access_log->file, 0, SEEK_END);
+        access_log->file_bytes = (size_t)ftell(access_log->file);
+    }
+
+    // Keeps one previous generation as <file>.1
+    static void rotate_log_file()
+    {
+        fclose(access_log->file);
+        acul::string previous = access_log->path + ".1";
+        remove(previous.c_str());
+        rename(access_log->path.c_str(), previous.c_str());
+        open_log_file();
+    }
+
+    static void write_line(const char *line, int len)
+    {
+        if (!access_log->file || len <= 0) return;
+        fwrite(line, 1, (size_t)len, access_log->file);
+        access_log->file_bytes += (size_t)len;
+        if (access_log->max_bytes && access_log->file_bytes >= access_log->max_bytes) rotate_log_file();
+    }
+
+    static void write_record(const AccessRecord &r)
+    {
+        // The file is gone after a failed rotation; errors still reach the app log
+        if (!access_log->file)
+        {
+            if (r.error[0]) LOG_ERROR("%s", r.error);
+            return;
+        }
+        const time_t seconds = (time_t)(r.time_ms / 1000);
+        tm utc;
+#ifdef _WIN32
+        gmtime_s(&utc, &seconds);
+#else
+        gmtime_r(&seconds, &utc);
+#endif
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &utc);
+
+        char line[384];
+        int len = snprintf(line, sizeof(line), "%s.%03dZ %s %s %u %uus %uB%s%s\n", stamp, (int)(r.time_ms % 1000),
+                           method_name(r.method), r.path, r.status, r.latency_us, r.size, r.error[0] ? " " : "",
+                           r.error);
+        write_line(line, std::min<int>(len, (int)sizeof(line) - 1));
+    }
+
+    static void drain_access_log()
+    {
+        auto *log = access_log;
+        bool wrote = false;
+        for (;;)
+        {
+            AccessSlot &slot = log->slots[log->tail & log->mask];
+            if (slot.seq.load(std::memory_order_acquire) != log->tail + 1) break;
+            write_record(slot.record);
+            slot.seq.store(log->tail + log->mask + 1, std::memory_order_release);
+            ++log->tail;
+            wrote = true;
+        }
+        if (u64 dropped = log->dropped.exchange(0, std::memory_order_relaxed))
+        {
+            char line[64];
+            write_line(line, snprintf(line, sizeof(line), "# %llu records dropped\n", (unsigned long long)dropped));
+            wrote = true;
+        }
+        if (wrote && log->file) fflush(log->file);
+    }
+
+    static void run_writer()
+    {
+        std::unique_lock<std::mutex> lock(access_log->lock);
+        while (!access_log->cv.wait_for(lock, std::chrono::milliseconds(100), [] { return access_log->stop; }))
+            drain_access_log();
+        drain_access_log();
+    }
+
+    bool start_access_log(const char *path, u32 capacity, u32 sample, size_t max_bytes)
+    {
+        if (access_log || !path) return false;
+        access_log = acul::alloc<AccessLog>();
+        access_log->path = path;
+        open_log_file();
+        if (!access_log->file)
+        {
+            acul::release(access_log);
+            access_log = nullptr;
+            return false;
+        }
+
+        u64 slots = 64;
+        while (slots < capacity) slots <<= 1;
+        access_log->slots = std::make_unique<AccessSlot[]>(slots);
+        for (u64 i = 0; i < slots; ++i) access_log->slots[i].seq.store(i, std::memory_order_relaxed);
+        access_log->mask = slots - 1;
+        access_log->sample = sample ? sample : 1;
+        access_log->max_bytes = max_bytes;
+        access_log->writer = std::thread(run_writer);
+        active.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop_access_log()
+    {
+        if (!access_log) return;
+        active.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(access_log->lock);
+            access_log->stop = true;
+        }
+        access_log->cv.notify_all();
+        access_log->writer.join();
+        if (access_log->file) fclose(access_log->file);
+        acul::release(access_log);
+        access_log = nullptr;
+    }
+} // namespace alwf
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <alwf/async.hpp>
+#include "framework.hpp"
+
+namespace alwf
+{
+    // Link header values per page, built on first request. Main thread only.
+    static acul::hashmap<acul::string, acul::string> preload_headers;
+
+    static const char *preload_type(const char *url)
+    {
+        const char *dot = strrchr(url, '.');
+        if (!dot) return nullptr;
+        acul::string ext = acul::to_lower(acul::string(dot + 1));
+        if (ext == "js") return "script";
+        if (ext == "css") return "style";
+        if (ext == "woff" || ext == "woff2" || ext == "ttf" || ext == "otf") return "font";
+        if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "gif" || ext == "webp" || ext == "svg")
+            return "image";
+        return nullptr;
+    }
+
+    static acul::string build_preload_header(const char *const *items)
+    {
+        acul::string header;
+        for (auto *item = items; *item; ++item)
+        {
+            const char *type = preload_type(*item);
+            if (!type) continue;
+            if (!header.empty()) header.append(", ");
+            header.append(acul::format("<%s>; rel=preload; as=%s", *item, type));
+            if (strcmp(type, "font") == 0) header.append("; crossorigin");
+        }
+        return header;
+    }
+
+    // Assets being read by warm_assets(), so repeated page hits do not read them again. Main thread only.
+    static acul::vector<acul::string> warming;
+
+    static bool is_warming(const char *path)
+    {
+        return std::find(warming.begin(), warming.end(), path) != warming.end();
+    }
+
+    // Reads uncached assets on the background pool; the results are moved into the file cache on the main thread
+    static void warm_assets(const char *const *items)
+    {
+        acul::vector<acul::string> missing;
+        for (auto *item = items; *item; ++item)
+            if (ctx->file_cache.find(*item) == ctx->file_cache.end() && !is_warming(*item)) missing.emplace_back(*item);
+        if (missing.empty()) return;
+        warming.insert(warming.end(), missing.begin(), missing.end());
+
+        // The job does not touch ctx, which shutdown() may release before the posted result runs
+        detail::run_in_background([folder = acul::string(ctx->static_folder), missing = std::move(missing)]() mutable {
+            TraceScope trace("warm assets");
+            acul::vector<std::pair<acul::string, IResponse *>> loaded;
+            for (auto &path : missing)
+                if (IResponse *res = load_static_file_from_disk(folder.c_str(), path)) loaded.emplace_back(path, res);
+            post_to_main([missing = std::move(missing), loaded = std::move(loaded)]() {
+                for (auto &path : missing)
+                    if (auto it = std::find(warming.begin(), warming.end(), path); it != warming.end())
+                        warming.erase(it);
+                for (auto &[path, res] : loaded)
+                {
+                    if (!ctx || ctx->file_cache.find(path) != ctx->file_cache.end()) acul::release(res);
+                    else
+                    {
+                        ctx->file_cache_bytes += res->size();
+                        ctx->file_cache.emplace(path, acul::unique_ptr<IResponse>(res));
+                    }
+                }
+            });
+        });
+    }
+
+    const char *prepare_page_assets(const Request &req)
+    {
+        if (req.method != Method::get) return nullptr;
+        auto it = ctx->router->assets.find(req.path);
+        if (it == ctx->router->assets.end() || !it->second) return nullptr;
+
+        warm_assets(it->second);
+        auto header = preload_headers.find(req.path);
+        if (header == preload_headers.end())
+            header = preload_headers.emplace(req.path, build_preload_header(it->second)).first;
+        return header->second.empty() ? nullptr : header->second.c_str();
+    }
+
+    void prewarm_page_assets(const char *path)
+    {
+        auto it = ctx->router->assets.find(path);
+        if (it != ctx->router->assets.end() && it->second) warm_assets(it->second);
+    }
+
+    void destroy_page_assets()
+    {
+        preload_headers.clear();
+        warming.clear();
+    }
+} // namespace alwf
@@ -0,0 +1,155 @@
+#include <acul/io/fs/file.hpp>
+#include <acul/log.hpp>
+#include <algorithm>
+#include <alwf/async.hpp>
+#include <stdexcept>
+#include <thread>
+#include "framework.hpp"
+
+namespace alwf
+{
+    // Shared by every background() await, so suspended handlers never hold a thread of their own
+    static struct BackgroundPool
+    {
+        std::mutex lock;
+        std::condition_variable cv;
+        acul::vector<std::function<void()>> jobs;
+        acul::vector<std::thread> threads;
+        bool stopping = false;
+    } *pool = nullptr;
+
+    static std::mutex pool_lock;
+
+    static void run_pool_worker(BackgroundPool *p)
+    {
+        for (;;)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(p->lock);
+                p->cv.wait(lock, [p] { return p->stopping || !p->jobs.empty(); });
+                if (p->jobs.empty()) return;
+                job = std::move(p->jobs.front());
+                p->jobs.erase(p->jobs.begin());
+            }
+            job();
+        }
+    }
+
+    void stop_background_pool()
+    {
+        BackgroundPool *p = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(pool_lock);
+            std::swap(p, pool);
+        }
+        if (!p) return;
+        {
+            std::lock_guard<std::mutex> lock(p->lock);
+            p->stopping = true;
+        }
+        p->cv.notify_all();
+        for (auto &t : p->threads) t.join();
+        acul::release(p);
+    }
+
+    namespace detail
+    {
+        void resume_on_main(std::coroutine_handle<> h, WindowId window)
+        {
+            post_to_main([h, window]() {
+                WindowScope scope(window);
+                h.resume();
+            });
+        }
+
+        void resume_after(std::coroutine_handle<> h, u32 ms)
+        {
+            post_delayed(ms, [h, window = current_window()]() {
+                WindowScope scope(window);
+                h.resume();
+            });
+        }
+
+        void run_in_background(std::function<void()> &&job)
+        {
+            std::lock_guard<std::mutex> lock(pool_lock);
+            if (!pool)
+            {
+                pool = acul::alloc<BackgroundPool>();
+                const u32 count = std::max(2u, std::thread::hardware_concurrency());
+                for (u32 i = 0; i < count; ++i) pool->threads.emplace_back(run_pool_worker, pool);
+            }
+            {
+                std::lock_guard<std::mutex> jobs_lock(pool->lock);
+                pool->jobs.push_back(std::move(job));
+            }
+            pool->cv.notify_one();
+        }
+    } // namespace detail
+
+    void spawn(Task<> task)
+    {
+        detail::drive(std::move(task), [](std::exception_ptr error) {
+            if (!error) return;
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("Async task failed: %s", e.what());
+            }
+            catch (...)
+            {
+                LOG_ERROR("Async task failed");
+            }
+        });
+    }
+
+    Task<acul::vector<char>> read_file(acul::string path)
+    {
+        co_return co_await background([path = std::move(path)]() {
+            acul::vector<char> data;
+            if (!acul::fs::read_binary(path, data))
+                throw std::runtime_error(acul::format("Cannot read %s", path.c_str()).c_str());
+            return data;
+        });
+    }
+
+    RouteHandler async_route(AsyncRouteHandler handler)
+    {
+        return [handler = std::move(handler)](const Request &req) -> IResponse * {
+            auto *pending = acul::alloc<PendingResponse>();
+            detail::drive(handler(req), [pending](IResponse *res, std::exception_ptr error) {
+                if (!pending->on_complete)
+                {
+                    pending->done = true;
+                    pending->result = res;
+                    pending->error = error;
+                    return;
+                }
+                auto complete = std::move(pending->on_complete);
+                complete(res, error);
+                acul::release(pending);
+            });
+            if (!pending->done) return pending;
+
+            // Completed without suspending: answer like a plain route
+            IResponse *res = pending->result;
+            std::exception_ptr error = pending->error;
+            acul::release(pending);
+            if (error) std::rethrow_exception(error);
+            return res;
+        };
+    }
+
+    EventHandler async_handler(AsyncEventHandler handler)
+    {
+        return [handler = std::move(handler)](const rapidjson::Value &value) {
+            rapidjson::Document doc;
+            doc.CopyFrom(value, doc.GetAllocator());
+            spawn(handler(std::move(doc)));
+        };
+    }
+} // namespace alwf
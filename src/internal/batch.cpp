@@ -0,0 +1,165 @@
+#include <acul/string/utils.hpp>
+#include <rapidjson/writer.h>
+#include "framework.hpp"
+
+namespace alwf
+{
+    // One /__alwf/batch request. Lives until its last deferred sub-request completes; main thread only.
+    struct Batch
+    {
+        struct Item
+        {
+            Request req;
+            HeaderMap headers; // req.headers points here, so items are never moved once dispatched
+            IResponse *res = nullptr;
+            u16 status = 404;
+        };
+
+        acul::vector<Item> items;
+        size_t outstanding = 0;
+        PendingResponse *pending = nullptr;
+    };
+
+    static const char *string_member(const rapidjson::Value &v, const char *name)
+    {
+        auto it = v.FindMember(name);
+        return it != v.MemberEnd() && it->value.IsString() ? it->value.GetString() : nullptr;
+    }
+
+    static bool parse_item(const rapidjson::Value &v, Batch::Item &item)
+    {
+        const char *path = v.IsObject() ? string_member(v, "path") : nullptr;
+        if (!path || path[0] != '/') return false;
+        parse_request_url(path, item.req);
+        if (const char *query = string_member(v, "query")) item.req.query = query;
+        if (const char *body = string_member(v, "body")) item.req.body = body;
+
+        const char *method = string_member(v, "method");
+        if (!method) item.req.method = Method::get;
+        else if (!parse_method(method, item.req.method)) return false;
+
+        if (auto headers = v.FindMember("headers"); headers != v.MemberEnd() && headers->value.IsObject())
+            for (auto h = headers->value.MemberBegin(); h != headers->value.MemberEnd(); ++h)
+                if (h->value.IsString())
+                    item.headers[acul::to_lower(acul::string(h->name.GetString()))] = h->value.GetString();
+        item.req.request_ctx = nullptr;
+        item.req.headers = &item.headers;
+        return true;
+    }
+
+    static void keep_result(Batch::Item &item, const DispatchResult &result)
+    {
+        switch (result.kind)
+        {
+            case DispatchKind::owned:
+                item.res = result.res;
+                item.status = result.status;
+                break;
+            case DispatchKind::cached:
+            {
+                // The file cache may be trimmed before the rest of the batch is done
+                acul::vector<char> data(result.res->data(), result.res->data() + result.res->size());
+                item.res = acul::alloc<BinaryResponse>(std::move(data), result.res->content_type);
+                item.status = result.status;
+                break;
+            }
+            default:
+                // Includes the push stream, which cannot be multiplexed
+                item.status = 404;
+                break;
+        }
+    }
+
+    // A JSON line describing each sub-response, followed by their bodies back to back
+    static IResponse *frame_batch(Batch *batch)
+    {
+        acul::string out;
+        {
+            StringOutputStream os{out};
+            rapidjson::Writer<StringOutputStream> w(os);
+            w.StartArray();
+            for (auto &item : batch->items)
+            {
+                w.StartObject();
+                w.Key("status");
+                w.Uint(item.status);
+                w.Key("type");
+                w.String(item.res && item.res->content_type ? item.res->content_type : "text/plain");
+                w.Key("size");
+                w.Uint64(item.res ? item.res->size() : 0);
+                w.EndObject();
+            }
+            w.EndArray();
+        }
+        out.push_back('\n');
+        for (auto &item : batch->items)
+        {
+            if (!item.res) continue;
+            out.append(item.res->data(), item.res->data() + item.res->size());
+            acul::release(item.res);
+        }
+        return acul::alloc<TextResponse>(std::move(out), "application/x-alwf-batch");
+    }
+
+    static void complete_batch(Batch *batch)
+    {
+        IResponse *res = frame_batch(batch);
+        PendingResponse *pending = batch->pending;
+        acul::release(batch);
+        if (pending->on_complete)
+        {
+            auto complete = std::move(pending->on_complete);
+            complete(res, nullptr);
+        }
+        else acul::release(res);
+        acul::release(pending);
+    }
+
+    IResponse *dispatch_batch(const Request &req)
+    {
+        rapidjson::Document doc;
+        doc.Parse(req.body.c_str(), req.body.size());
+        if (doc.HasParseError() || !doc.IsArray()) return nullptr;
+
+        auto *batch = acul::alloc<Batch>();
+        batch->items.resize(doc.Size());
+        for (rapidjson::SizeType i = 0; i < doc.Size(); ++i)
+        {
+            if (parse_item(doc[i], batch->items[i])) continue;
+            acul::release(batch);
+            return nullptr;
+        }
+
+        // Synchronous routes run one after another on the main thread; coroutine routes all start here and
+        // overlap while suspended
+        for (size_t i = 0; i < batch->items.size(); ++i)
+        {
+            // A nested batch would recurse without bound
+            if (batch->items[i].req.path == "/__alwf/batch")
+            {
+                batch->items[i].status = 400;
+                continue;
+            }
+            DispatchResult result = dispatch_request(batch->items[i].req);
+            if (result.kind != DispatchKind::deferred)
+            {
+                keep_result(batch->items[i], result);
+                continue;
+            }
+            ++batch->outstanding;
+            result.pending->finish = [batch, i](const DispatchResult &done) {
+                keep_result(batch->items[i], done);
+                if (--batch->outstanding == 0) complete_batch(batch);
+            };
+        }
+        if (batch->outstanding)
+        {
+            batch->pending = acul::alloc<PendingResponse>();
+            return batch->pending;
+        }
+
+        IResponse *res = frame_batch(batch);
+        acul::release(batch);
+        return res;
+    }
+} // namespace alwf
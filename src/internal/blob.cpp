@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include "framework.hpp"
+
+namespace alwf
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct BlobEntry
+    {
+        Blob *blob;
+        u32 deliveries;
+        Clock::time_point expires;
+    };
+
+    static constexpr char blob_prefix[] = "/__blob/";
+
+    static std::mutex blobs_lock;
+    static acul::hashmap<BlobId, BlobEntry> blobs;
+    static std::atomic<BlobId> next_blob_id{1};
+
+    Blob *make_blob(acul::vector<char> &&data, const char *content_type)
+    {
+        Blob *blob = acul::alloc<Blob>();
+        blob->data = std::move(data);
+        blob->content_type = content_type;
+        return blob;
+    }
+
+    void unref_blob(Blob *blob)
+    {
+        if (blob->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) acul::release(blob);
+    }
+
+    // Deadline of the armed sweep, guarded by blobs_lock. Every blob gets the same TTL, so deadlines arrive in order
+    // and one sweep is armed at a time.
+    static Clock::time_point next_sweep = Clock::time_point::max();
+
+    static u32 ms_until(Clock::time_point deadline)
+    {
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        return ms > 0 ? (u32)ms : 0;
+    }
+
+    // Main thread only, like post_delayed()
+    static void sweep_blobs()
+    {
+        const auto now = Clock::now();
+        auto earliest = Clock::time_point::max();
+        {
+            std::lock_guard<std::mutex> lock(blobs_lock);
+            next_sweep = Clock::time_point::max();
+            for (auto it = blobs.begin(); it != blobs.end();)
+            {
+                if (it->second.expires > now)
+                {
+                    earliest = std::min(earliest, it->second.expires);
+                    ++it;
+                    continue;
+                }
+                unref_blob(it->second.blob);
+                it = blobs.erase(it);
+            }
+            if (earliest == Clock::time_point::max()) return;
+            next_sweep = earliest;
+        }
+        post_delayed(ms_until(earliest), sweep_blobs);
+    }
+
+    BlobId register_blob(acul::vector<char> &&data, const char *content_type, u32 deliveries)
+    {
+        assert(ctx && "Context is not initialized");
+        const auto now = Clock::now();
+        auto expires = ctx->blob_ttl_ms ? now + std::chrono::milliseconds(ctx->blob_ttl_ms) : Clock::time_point::max();
+        BlobId id = next_blob_id.fetch_add(1, std::memory_order_relaxed);
+        Blob *blob = make_blob(std::move(data), content_type);
+
+        {
+            std::lock_guard<std::mutex> lock(blobs_lock);
+            blobs.emplace(id, BlobEntry{blob, deliveries ? deliveries : 1, expires});
+            if (expires >= next_sweep) return id;
+            next_sweep = expires;
+        }
+        // Undelivered blobs are freed by a timer, so they do not wait for the next registration
+        post_to_main([expires]() { post_delayed(ms_until(expires), sweep_blobs); });
+        return id;
+    }
+
+    void release_blob(BlobId id)
+    {
+        std::lock_guard<std::mutex> lock(blobs_lock);
+        auto it = blobs.find(id);
+        if (it == blobs.end()) return;
+        unref_blob(it->second.blob);
+        blobs.erase(it);
+    }
+
+    IResponse *acquire_blob_response(const acul::string &path)
+    {
+        constexpr size_t prefix_len = sizeof(blob_prefix) - 1;
+        if (path.size() <= prefix_len || path.compare(0, prefix_len, blob_prefix) != 0) return nullptr;
+
+        char *end = nullptr;
+        BlobId id = strtoull(path.c_str() + prefix_len, &end, 10);
+        if (!end || *end != '\0') return nullptr;
+
+        std::lock_guard<std::mutex> lock(blobs_lock);
+        auto it = blobs.find(id);
+        if (it == blobs.end()) return nullptr;
+
+        IResponse *res = acul::alloc<BlobResponse>(it->second.blob);
+        if (--it->second.deliveries == 0)
+        {
+            unref_blob(it->second.blob);
+            blobs.erase(it);
+        }
+        return res;
+    }
+
+    void send_blob_to_frontend(const char *handler, BlobId id, WindowId window)
+    {
+        size_t size = 0;
+        {
+            std::lock_guard<std::mutex> lock(blobs_lock);
+            auto it = blobs.find(id);
+            if (it == blobs.end()) return;
+            size = it->second.blob->data.size();
+        }
+
+        rapidjson::StringBuffer buf;
+        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+        w.StartObject();
+        w.Key("handler");
+        w.String(handler);
+        w.Key("__blob");
+        w.Uint64(id);
+        w.Key("size");
+        w.Uint64(size);
+        w.EndObject();
+        acul::string json(buf.GetString(), buf.GetSize());
+        post_to_main([json = std::move(json), window]() { send_raw_to_frontend(json, window); });
+    }
+
+    size_t blob_bytes()
+    {
+        std::lock_guard<std::mutex> lock(blobs_lock);
+        size_t bytes = 0;
+        for (auto &[id, entry] : blobs) bytes += entry.blob->data.size();
+        return bytes;
+    }
+
+    void destroy_blobs()
+    {
+        std::lock_guard<std::mutex> lock(blobs_lock);
+        for (auto &[id, entry] : blobs) unref_blob(entry.blob);
+        blobs.clear();
+    }
+} // namespace alwf
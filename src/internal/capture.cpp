@@ -0,0 +1,191 @@
+// Traffic capture for alwf_replay. The file is "ALWFCAP" followed by a version byte, then one record per event:
+//   kind:u8  dt_us:varint (since the previous record)
+//   request:  method:u8 path:str query:str body:str header_count:varint (name:str value:str)*
+//   message / outbound: json:str
+// where str is a varint length followed by the bytes.
+#include <acul/io/fs/file.hpp>
+#include <acul/log.hpp>
+#include <cstdio>
+#include <mutex>
+#include "framework.hpp"
+
+namespace alwf
+{
+    static constexpr char capture_magic[8] = {'A', 'L', 'W', 'F', 'C', 'A', 'P', 1};
+
+    // Headers the dispatch layer reads; native requests are captured with these only
+    static const struct
+    {
+        const ACUL_NATIVE_CHAR *name;
+        const char *key;
+    } captured_headers[] = {{ACUL_C_STR("Accept"), "accept"},
+                            {ACUL_C_STR("X-Requested-With"), "x-requested-with"},
+                            {ACUL_C_STR("X-Alwf-Fragment"), "x-alwf-fragment"}};
+
+    static std::atomic<bool> capturing{false};
+    static std::mutex capture_lock;
+    static FILE *capture_file = nullptr;
+    static MetricsClock::time_point last_record;
+    static acul::string record_buf;
+
+    static void put_varint(acul::string &out, u64 v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back((char)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((char)v);
+    }
+
+    static void put_str(acul::string &out, const char *data, size_t len)
+    {
+        put_varint(out, len);
+        out.append(data, len);
+    }
+
+    static void put_str(acul::string &out, const acul::string &s) { put_str(out, s.c_str(), s.size()); }
+
+    bool start_capture(const char *path)
+    {
+        std::lock_guard<std::mutex> lock(capture_lock);
+        if (capture_file) return false;
+        capture_file = fopen(path, "wb");
+        if (!capture_file)
+        {
+            LOG_ERROR("Failed to open capture file: %s", path);
+            return false;
+        }
+        fwrite(capture_magic, 1, sizeof(capture_magic), capture_file);
+        last_record = MetricsClock::now();
+        capturing.store(true, std::memory_order_release);
+        LOG_INFO("Capturing traffic to %s", path);
+        return true;
+    }
+
+    void stop_capture()
+    {
+        std::lock_guard<std::mutex> lock(capture_lock);
+        capturing.store(false, std::memory_order_relaxed);
+        if (!capture_file) return;
+        fclose(capture_file);
+        capture_file = nullptr;
+    }
+
+    bool capture_active() { return capturing.load(std::memory_order_relaxed); }
+
+    // Records are serialized into one reused buffer under the lock, then written with a single fwrite
+    template <typename F>
+    static void write_record(CaptureKind kind, F &&payload)
+    {
+        std::lock_guard<std::mutex> lock(capture_lock);
+        if (!capture_file) return;
+        const auto now = MetricsClock::now();
+        record_buf.clear();
+        record_buf.push_back((char)kind);
+        put_varint(record_buf, (u64)std::chrono::duration_cast<std::chrono::microseconds>(now - last_record).count());
+        last_record = now;
+        payload(record_buf);
+        fwrite(record_buf.data(), 1, record_buf.size(), capture_file);
+    }
+
+    void capture_request(const Request &req)
+    {
+        write_record(CaptureKind::request, [&req](acul::string &out) {
+            out.push_back((char)req.method);
+            put_str(out, req.path);
+            put_str(out, req.query);
+            put_str(out, req.body);
+            if (req.headers)
+            {
+                put_varint(out, req.headers->size());
+                for (auto &[name, value] : *req.headers)
+                {
+                    put_str(out, name);
+                    put_str(out, value);
+                }
+                return;
+            }
+            acul::vector<std::pair<const char *, acul::string>> found;
+            for (auto &header : captured_headers)
+                if (auto value = req.get_header(header.name); !value.empty())
+                    found.emplace_back(header.key, std::move(value));
+            put_varint(out, found.size());
+            for (auto &[key, value] : found)
+            {
+                put_str(out, key, strlen(key));
+                put_str(out, value);
+            }
+        });
+    }
+
+    void capture_message(CaptureKind kind, const char *json, size_t len)
+    {
+        if (!capture_active()) return;
+        write_record(kind, [json, len](acul::string &out) { put_str(out, json, len); });
+    }
+
+    static bool get_varint(const char *&p, const char *end, u64 &v)
+    {
+        v = 0;
+        for (u32 shift = 0; p < end && shift < 64; shift += 7)
+        {
+            const u8 b = (u8)*p++;
+            v |= (u64)(b & 0x7f) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    static bool get_str(const char *&p, const char *end, acul::string &s)
+    {
+        u64 len;
+        if (!get_varint(p, end, len) || len > (u64)(end - p)) return false;
+        s.assign(p, (size_t)len);
+        p += len;
+        return true;
+    }
+
+    bool read_capture(const char *path, acul::vector<CaptureRecord> &records)
+    {
+        acul::vector<char> data;
+        if (!acul::fs::read_binary(path, data) || data.size() < sizeof(capture_magic) ||
+            memcmp(data.data(), capture_magic, sizeof(capture_magic)) != 0)
+            return false;
+
+        const char *p = data.data() + sizeof(capture_magic);
+        const char *end = data.data() + data.size();
+        u64 ts_us = 0;
+        while (p < end)
+        {
+            CaptureRecord r;
+            r.kind = (CaptureKind)*p++;
+            u64 dt;
+            if (!get_varint(p, end, dt)) return false;
+            r.ts_us = ts_us += dt;
+
+            if (r.kind == CaptureKind::request)
+            {
+                if (p >= end) return false;
+                r.method = (Method)*p++;
+                u64 header_count;
+                if (!get_str(p, end, r.path) || !get_str(p, end, r.query) || !get_str(p, end, r.body) ||
+                    !get_varint(p, end, header_count))
+                    return false;
+                for (u64 i = 0; i < header_count; ++i)
+                {
+                    acul::string name, value;
+                    if (!get_str(p, end, name) || !get_str(p, end, value)) return false;
+                    r.headers.emplace(std::move(name), std::move(value));
+                }
+            }
+            else if (r.kind == CaptureKind::message || r.kind == CaptureKind::outbound)
+            {
+                if (!get_str(p, end, r.json)) return false;
+            }
+            else return false;
+            records.push_back(std::move(r));
+        }
+        return true;
+    }
+} // namespace alwf
@@ -0,0 +1,302 @@
+#include <acul/log.hpp>
+#include <acul/string/utils.hpp>
+#include "framework.hpp"
+
+namespace alwf
+{
+    void parse_request_url(const acul::string &uri, Request &request)
+    {
+        acul::string path;
+        acul::string query;
+
+        if (auto qpos = uri.find('?'); qpos != acul::string::npos)
+        {
+            path = uri.substr(0, qpos);
+            query = uri.substr(qpos + 1);
+        }
+        else
+        {
+            path = uri;
+            query = "";
+        }
+
+        request.path = std::move(path);
+        request.query = std::move(query);
+    }
+
+    const char *method_name(Method method)
+    {
+        switch (method)
+        {
+            case Method::post:
+                return "POST";
+            case Method::put:
+                return "PUT";
+            case Method::del:
+                return "DELETE";
+            default:
+                return "GET";
+        }
+    }
+
+    bool parse_method(const char *name, Method &method)
+    {
+        if (strcmp(name, "GET") == 0) method = Method::get;
+        else if (strcmp(name, "POST") == 0) method = Method::post;
+        else if (strcmp(name, "PUT") == 0) method = Method::put;
+        else if (strcmp(name, "DELETE") == 0) method = Method::del;
+        else return false;
+        return true;
+    }
+
+    acul::string find_header(const HeaderMap &headers, const char *name)
+    {
+        auto it = headers.find(acul::to_lower(acul::string(name)));
+        return it == headers.end() ? acul::string{} : it->second;
+    }
+
+    bool wants_json(const Request &req)
+    {
+        auto accept = req.get_header(ACUL_C_STR("Accept"));
+        if (!accept.empty() && acul::find_insensitive_case(accept, "application/json") != acul::string::npos)
+            return true;
+
+        auto xrw = req.get_header(ACUL_C_STR("X-Requested-With"));
+        if (!xrw.empty())
+        {
+            auto ieq = [](const char *a, const char *b) {
+                for (; *a && *b; ++a, ++b)
+                {
+                    unsigned ca = (unsigned char)*a, cb = (unsigned char)*b;
+                    if (tolower(ca) != tolower(cb)) return false;
+                }
+                return *a == 0 && *b == 0;
+            };
+            if (ieq(xrw.c_str(), "fetch") || ieq(xrw.c_str(), "XMLHttpRequest")) return true;
+        }
+        return false;
+    }
+
+    // The error in the form the request expects
+    static IResponse *error_response(const Request &req, const char *err)
+    {
+        if (wants_json(req))
+        {
+            rapidjson::Document d;
+            d.SetObject();
+            auto &a = d.GetAllocator();
+            d.AddMember("success", false, a);
+            rapidjson::Value e(err, a);
+            d.AddMember("error", e, a);
+            return acul::alloc<JSONResponse>(std::move(d));
+        }
+        else { return acul::alloc<TextResponse>(err, "text/plain"); }
+    }
+
+    IResponse *emit_error(const Request &req, const char *err)
+    {
+        // With the access log on, the error is written with the request record instead. log_access() falls back to
+        // the app log when the record cannot be queued.
+        if (!access_log_active()) LOG_ERROR("%s", err);
+        return error_response(req, err);
+    }
+
+    static Router::route_store *route_store_for(Method method)
+    {
+        switch (method)
+        {
+            case Method::post:
+                return &ctx->router->post;
+            case Method::put:
+                return &ctx->router->put;
+            case Method::del:
+                return &ctx->router->del;
+            default:
+                return &ctx->router->get;
+        }
+    }
+
+    // Notes a page for prerendering and cuts it down to the requested fragments; a null result becomes an error
+    static IResponse *finish_route(const Request &req, IResponse *res, acul::string &error)
+    {
+        if (!res) return emit_error(req, (error = "Route handler returned null response").c_str());
+        note_served_page(req, res);
+        return extract_fragments(req, res);
+    }
+
+    // Routes the request and picks the endpoint its metrics are recorded under; none for the push stream
+    static DispatchResult route_request(const Request &req, EndpointStats *&stats, acul::string &error)
+    {
+        DispatchResult out;
+
+        if (req.method == Method::get)
+        {
+            if (IResponse *blob = acquire_blob_response(req.path))
+            {
+                stats = aggregate_stats(EndpointKind::blob);
+                out.kind = DispatchKind::owned;
+                out.res = blob;
+                return out;
+            }
+            if (req.path == "/__alwf/stream")
+            {
+                out.kind = DispatchKind::stream;
+                return out;
+            }
+#ifndef NDEBUG
+            if (req.path == "/__alwf/metrics")
+            {
+                out.kind = DispatchKind::owned;
+                out.res = acul::alloc<JSONResponse>(metrics_json());
+                return out;
+            }
+#endif
+        }
+
+        if (req.method == Method::post && req.path == "/__alwf/batch")
+        {
+            stats = aggregate_stats(EndpointKind::batch);
+            IResponse *res = dispatch_batch(req);
+            if (auto *pending = dynamic_cast<PendingResponse *>(res))
+            {
+                out.kind = DispatchKind::deferred;
+                out.pending = pending;
+                return out;
+            }
+            // A client error: answered with 400, not logged or counted as a handler error
+            if (!res)
+            {
+                res = error_response(req, "Malformed batch");
+                out.status = 400;
+            }
+            out.kind = DispatchKind::owned;
+            out.res = res;
+            return out;
+        }
+
+        Router::route_store *store = route_store_for(req.method);
+        auto it = store->find(req.path);
+        if (it != store->end())
+        {
+            stats = route_stats(req.method, req.path);
+            ActivityScope activity(stats);
+            const char *link = prepare_page_assets(req);
+            IResponse *res = lookup_route_cache(req);
+            if (!res) res = take_prerendered(req);
+            (res ? stats->cache_hits : stats->cache_misses).fetch_add(1, std::memory_order_relaxed);
+            try
+            {
+                if (!res)
+                {
+                    res = it->second(req);
+                    store_route_result(req, res);
+                }
+                if (auto *pending = dynamic_cast<PendingResponse *>(res))
+                {
+                    out.kind = DispatchKind::deferred;
+                    out.pending = pending;
+                    out.link = link;
+                    return out;
+                }
+                res = finish_route(req, res, error);
+            }
+            catch (const std::exception &e)
+            {
+                res = emit_error(req, (error = e.what()).c_str());
+            }
+            catch (...)
+            {
+                res = emit_error(req, (error = "Unknown error").c_str());
+            }
+            if (!error.empty()) stats->errors.fetch_add(1, std::memory_order_relaxed);
+
+            out.kind = DispatchKind::owned;
+            out.res = res;
+            if (res->content_type && strcmp(res->content_type, "text/html") == 0) out.link = link;
+            return out;
+        }
+
+        stats = aggregate_stats(EndpointKind::static_file);
+        ActivityScope activity(stats);
+        bool cached = false;
+        if (IResponse *res = load_static_file(req.path, &cached))
+        {
+            (cached ? stats->cache_hits : stats->cache_misses).fetch_add(1, std::memory_order_relaxed);
+            out.kind = DispatchKind::cached;
+            out.res = res;
+        }
+        else stats = aggregate_stats(EndpointKind::not_found);
+        return out;
+    }
+
+    // Answers a suspended coroutine route once it completes. The response is checked like a synchronous one, and
+    // the time from dispatch to completion is recorded as the route's completion latency.
+    static void complete_deferred(const Request &req, EndpointStats *stats, MetricsClock::time_point start,
+                                  PendingResponse *pending, const char *link)
+    {
+        pending->on_complete = [req, stats, start, pending, link = acul::string(link ? link : "")](
+                                   IResponse *res, std::exception_ptr ex) {
+            acul::string error;
+            ActivityScope activity(stats);
+            settle_route_flight(pending, res, ex);
+            try
+            {
+                if (ex) std::rethrow_exception(ex);
+                res = finish_route(req, res, error);
+            }
+            catch (const std::exception &e)
+            {
+                res = emit_error(req, (error = e.what()).c_str());
+            }
+            catch (...)
+            {
+                res = emit_error(req, (error = "Unknown error").c_str());
+            }
+            if (!error.empty()) stats->errors.fetch_add(1, std::memory_order_relaxed);
+
+            DispatchResult out;
+            out.kind = DispatchKind::owned;
+            out.res = res;
+            if (!error.empty()) out.status = 500;
+            if (!link.empty() && res->content_type && strcmp(res->content_type, "text/html") == 0)
+                out.link = link.c_str();
+            const u64 latency_us = elapsed_us(start);
+            stats->completion.record(latency_us);
+            stats->bytes.fetch_add(res->size(), std::memory_order_relaxed);
+            if (access_log_active())
+                log_access(req, out.status, latency_us, res->size(), error.empty() ? nullptr : error.c_str());
+            if (pending->finish) pending->finish(out);
+            else acul::release(res);
+        };
+    }
+
+    DispatchResult dispatch_request(const Request &req)
+    {
+        assert(ctx && ctx->router && "Context is not initialized");
+        // A batch is captured as the sub-requests it dispatches
+        if (capture_active() && req.path != "/__alwf/batch") capture_request(req);
+        const auto start = MetricsClock::now();
+        EndpointStats *stats = nullptr;
+        acul::string error;
+        DispatchResult out = route_request(req, stats, error);
+        const u64 latency_us = elapsed_us(start);
+        if (out.kind == DispatchKind::deferred)
+        {
+            stats->latency.record(latency_us);
+            complete_deferred(req, stats, start, out.pending, out.link);
+            out.link = nullptr;
+            return out;
+        }
+        const size_t size = out.res ? out.res->size() : 0;
+        if (stats)
+        {
+            stats->latency.record(latency_us);
+            stats->bytes.fetch_add(size, std::memory_order_relaxed);
+        }
+        if (!error.empty()) out.status = 500;
+        else if (out.kind == DispatchKind::not_found) out.status = 404;
+        if (access_log_active()) log_access(req, out.status, latency_us, size, error.empty() ? nullptr : error.c_str());
+        if (startup_tracing()) trace_span(acul::format("request %s", req.path.c_str()), start);
+        return out;
+    }
+} // namespace alwf
@@ -1,7 +1,9 @@
 #include "framework.hpp"
 #include <acul/io/fs/file.hpp>
 #include <acul/io/fs/path.hpp>
+#include <acul/log.hpp>
 #include <acul/string/utils.hpp>
+#include <algorithm>
 
 
 namespace alwf
@@ -34,15 +36,14 @@ namespace alwf
                                                              {"gif", {"image/gif", ResponseKind::binary}},
                                                              {"webp", {"image/webp", ResponseKind::binary}}};
 
-    IResponse *load_static_file_from_disk(const acul::string &path)
+    IResponse *load_static_file_from_disk(const char *folder, const acul::string &path)
     {
-        assert(ctx && "Context is not initialized");
         acul::string ext = acul::fs::get_extension(path);
         if (!ext.empty() && ext[0] == '.') ext.erase(0, 1);
         ext = acul::to_lower(ext);
 
         acul::vector<char> buffer;
-        const acul::string full = acul::format("%s/%s", ctx->static_folder, path.c_str());
+        const acul::string full = acul::format("%s/%s", folder, path.c_str());
         if (!acul::fs::read_binary(full, buffer)) return nullptr;
 
         const MimeInfo *mi = nullptr;
@@ -64,16 +65,329 @@ namespace alwf
         return acul::alloc<BinaryResponse>(std::move(buffer), ct);
     }
 
-    IResponse *load_static_file(const acul::string &path)
+    IResponse *load_static_file(const acul::string &path, bool *cached)
     {
         assert(ctx && "Context is not initialized");
         auto &cache = ctx->file_cache;
-        if (auto it = cache.find(path); it != cache.end()) return it->second.get();
+        if (auto it = cache.find(path); it != cache.end())
+        {
+            if (cached) *cached = true;
+            return it->second.get();
+        }
+        if (cached) *cached = false;
 
-        IResponse *raw = load_static_file_from_disk(path);
+        IResponse *raw = load_static_file_from_disk(ctx->static_folder, path);
         if (!raw) return nullptr;
 
         cache.emplace(path, acul::unique_ptr<IResponse>(raw));
+        ctx->file_cache_bytes += raw->size();
         return raw;
     }
+
+    static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f'; }
+
+    static bool is_tag_boundary(char c) { return is_space(c) || c == '>' || c == '/'; }
+
+    // Case-insensitive match of html[pos, pos + size) against a lowercase name
+    static bool equals_lower(const acul::string &html, size_t pos, size_t size, const char *name)
+    {
+        if (strlen(name) != size || pos + size > html.size()) return false;
+        for (size_t i = 0; i < size; ++i)
+            if (tolower((unsigned char)html[pos + i]) != name[i]) return false;
+        return true;
+    }
+
+    struct HtmlAttribute
+    {
+        size_t name, name_size;
+        size_t value, value_size;
+    };
+
+    // Reads the attribute at pos and moves past it. False at the '>' closing the tag or at the end of input.
+    static bool next_attribute(const acul::string &html, size_t &pos, HtmlAttribute &attr)
+    {
+        while (pos < html.size() && (is_space(html[pos]) || html[pos] == '/')) ++pos;
+        if (pos >= html.size() || html[pos] == '>') return false;
+        attr.name = pos;
+        while (pos < html.size() && !is_tag_boundary(html[pos]) && html[pos] != '=') ++pos;
+        attr.name_size = pos - attr.name;
+        attr.value = pos;
+        attr.value_size = 0;
+
+        size_t eq = pos;
+        while (eq < html.size() && is_space(html[eq])) ++eq;
+        if (eq >= html.size() || html[eq] != '=') return true;
+        pos = eq + 1;
+        while (pos < html.size() && is_space(html[pos])) ++pos;
+        if (pos < html.size() && (html[pos] == '"' || html[pos] == '\''))
+        {
+            size_t close = html.find(html[pos], pos + 1);
+            if (close == acul::string::npos) close = html.size();
+            attr.value = pos + 1;
+            attr.value_size = close - attr.value;
+            pos = std::min(close + 1, html.size());
+            return true;
+        }
+        attr.value = pos;
+        while (pos < html.size() && !is_space(html[pos]) && html[pos] != '>') ++pos;
+        attr.value_size = pos - attr.value;
+        return true;
+    }
+
+    bool next_html_tag(const acul::string &html, size_t from, HtmlTag &tag)
+    {
+        for (size_t pos = html.find('<', from); pos != acul::string::npos; pos = html.find('<', pos + 1))
+        {
+            if (html.compare(pos, 4, "<!--") == 0)
+            {
+                size_t close = html.find("-->", pos + 4);
+                if (close == acul::string::npos) return false;
+                pos = close + 2;
+                continue;
+            }
+            if (pos + 1 < html.size() && (html[pos + 1] == '!' || html[pos + 1] == '?'))
+            {
+                size_t gt = html.find('>', pos);
+                if (gt == acul::string::npos) return false;
+                pos = gt;
+                continue;
+            }
+
+            const bool closing = pos + 1 < html.size() && html[pos + 1] == '/';
+            const size_t name = pos + (closing ? 2 : 1);
+            if (name >= html.size() || !isalpha((unsigned char)html[name])) continue; // a literal '<'
+            size_t name_end = name;
+            while (name_end < html.size() && !is_tag_boundary(html[name_end])) ++name_end;
+
+            // Quoted attribute values may contain '>'
+            size_t end = name_end;
+            HtmlAttribute attr;
+            while (next_attribute(html, end, attr));
+            if (end >= html.size()) return false;
+            tag = HtmlTag{pos, end + 1, name, name_end - name, name_end, closing};
+            return true;
+        }
+        return false;
+    }
+
+    bool html_tag_is(const acul::string &html, const HtmlTag &tag, const char *name)
+    {
+        return equals_lower(html, tag.name, tag.name_size, name);
+    }
+
+    bool html_attribute(const acul::string &html, const HtmlTag &tag, const char *name, acul::string &value)
+    {
+        HtmlAttribute attr;
+        for (size_t pos = tag.attrs; next_attribute(html, pos, attr);)
+        {
+            if (!equals_lower(html, attr.name, attr.name_size, name)) continue;
+            value.assign(html.c_str() + attr.value, attr.value_size);
+            return true;
+        }
+        return false;
+    }
+
+    size_t after_html_tag(const acul::string &html, const HtmlTag &tag)
+    {
+        if (tag.closing) return tag.end;
+        for (const char *raw : {"script", "style", "textarea", "title", "template"})
+        {
+            if (!html_tag_is(html, tag, raw)) continue;
+            // The body is text up to the first end tag of the same name
+            const size_t len = strlen(raw);
+            for (size_t pos = html.find("</", tag.end); pos != acul::string::npos; pos = html.find("</", pos + 2))
+                if (equals_lower(html, pos + 2, len, raw) && pos + 2 + len < html.size() &&
+                    is_tag_boundary(html[pos + 2 + len]))
+                    return pos;
+            return html.size();
+        }
+        return tag.end;
+    }
+
+    void for_each_html_attribute(const acul::string &html, const char *tag_name, const char *attr,
+                                 const std::function<void(acul::string &&)> &fn)
+    {
+        HtmlTag tag;
+        acul::string value;
+        for (size_t pos = 0; next_html_tag(html, pos, tag); pos = after_html_tag(html, tag))
+            if (!tag.closing && html_tag_is(html, tag, tag_name) && html_attribute(html, tag, attr, value))
+                fn(std::move(value));
+    }
+
+    static bool is_void_element(const acul::string &html, const HtmlTag &tag)
+    {
+        for (const char *name : {"area", "base", "br", "col", "embed", "hr", "img", "input", "link", "meta", "source",
+                                 "track", "wbr"})
+            if (html_tag_is(html, tag, name)) return true;
+        return false;
+    }
+
+    // Returns the end of the outer HTML of the element opened by `open`, honouring nested elements of the same tag
+    static bool match_element(const acul::string &html, const HtmlTag &open, size_t &end)
+    {
+        if (is_void_element(html, open))
+        {
+            end = open.end;
+            return true;
+        }
+        const acul::string name = acul::to_lower(html.substr(open.name, open.name_size));
+        int depth = 0;
+        HtmlTag tag;
+        for (size_t pos = open.begin; next_html_tag(html, pos, tag); pos = after_html_tag(html, tag))
+        {
+            if (!html_tag_is(html, tag, name.c_str())) continue;
+            if (!tag.closing) ++depth;
+            else if (--depth == 0)
+            {
+                end = tag.end;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Supported selectors: a tag name ("main") or an element id ("#content")
+    static bool find_element(const acul::string &html, const acul::string &selector, size_t &begin, size_t &end)
+    {
+        if (selector.empty()) return false;
+        const bool by_id = selector[0] == '#';
+        const acul::string name = by_id ? acul::string(selector.c_str() + 1) : acul::to_lower(selector);
+        HtmlTag tag;
+        acul::string id;
+        for (size_t pos = 0; next_html_tag(html, pos, tag); pos = after_html_tag(html, tag))
+        {
+            if (tag.closing) continue;
+            if (by_id ? !html_attribute(html, tag, "id", id) || id != name : !html_tag_is(html, tag, name.c_str()))
+                continue;
+            begin = tag.begin;
+            return match_element(html, tag, end);
+        }
+        return false;
+    }
+
+    IResponse *extract_fragments(const Request &req, IResponse *res)
+    {
+        if (!res->content_type || strcmp(res->content_type, "text/html") != 0) return res;
+        acul::string selectors = req.get_header(ACUL_C_STR("X-Alwf-Fragment"));
+        if (selectors.empty()) return res;
+
+        const acul::string html(res->data(), res->size());
+        rapidjson::Document d;
+        d.SetObject();
+        auto &a = d.GetAllocator();
+
+        rapidjson::Value fragments(rapidjson::kObjectType);
+        for (size_t start = 0; start <= selectors.size();)
+        {
+            size_t comma = selectors.find(',', start);
+            if (comma == acul::string::npos) comma = selectors.size();
+            acul::string selector = selectors.substr(start, comma - start);
+            start = comma + 1;
+            while (!selector.empty() && selector[0] == ' ') selector.erase(0, 1);
+            while (!selector.empty() && selector[selector.size() - 1] == ' ') selector.erase(selector.size() - 1, 1);
+
+            size_t begin = 0, end = 0;
+            if (!find_element(html, selector, begin, end)) continue;
+            fragments.AddMember(rapidjson::Value(selector.c_str(), (rapidjson::SizeType)selector.size(), a),
+                                rapidjson::Value(html.c_str() + begin, (rapidjson::SizeType)(end - begin), a), a);
+        }
+        d.AddMember("fragments", fragments, a);
+
+        HtmlTag tag;
+        for (size_t pos = 0; next_html_tag(html, pos, tag); pos = after_html_tag(html, tag))
+        {
+            if (tag.closing || !html_tag_is(html, tag, "title")) continue;
+            const size_t title_end = after_html_tag(html, tag);
+            if (title_end < html.size())
+                d.AddMember("title",
+                            rapidjson::Value(html.c_str() + tag.end, (rapidjson::SizeType)(title_end - tag.end), a), a);
+            break;
+        }
+
+        rapidjson::Value scripts(rapidjson::kArrayType);
+        for_each_html_attribute(html, "script", "src", [&scripts, &a](acul::string &&src) {
+            scripts.PushBack(rapidjson::Value(src.c_str(), (rapidjson::SizeType)src.size(), a), a);
+        });
+        d.AddMember("scripts", scripts, a);
+
+        acul::release(res);
+        return acul::alloc<JSONResponse>(std::move(d));
+    }
+
+    static WindowId current = main_window;
+
+    WindowId current_window() { return current; }
+
+    WindowId swap_current_window(WindowId id)
+    {
+        WindowId prev = current;
+        current = id;
+        enter_window_language(id);
+        return prev;
+    }
+
+    void dispatch_message(const char *json)
+    {
+        assert(ctx && "Context is not initialized");
+        if (capture_active()) capture_message(CaptureKind::message, json, strlen(json));
+        rapidjson::Document doc;
+        doc.Parse(json);
+        if (doc.HasParseError() || !doc.IsObject()) return;
+
+        auto h = doc.FindMember("handler");
+        if (h == doc.MemberEnd() || !h->value.IsString()) return;
+        const char *handler = h->value.GetString();
+
+        auto call = doc.FindMember("__call");
+        if (call != doc.MemberEnd() && call->value.IsString())
+        {
+            if (strcmp(handler, "__alwf_cancel") == 0) cancel_call(call->value.GetString());
+            else begin_call(handler, doc);
+            return;
+        }
+
+        if (strcmp(handler, "__alwf_first_paint") == 0)
+        {
+            if (!startup_tracing()) return;
+            auto at = doc.FindMember("at");
+            trace_instant("first paint", at != doc.MemberEnd() && at->value.IsNumber()
+                                             ? acul::format("{\"page_ms\":%.1f}", at->value.GetDouble())
+                                             : acul::string{});
+            finish_startup_trace();
+            return;
+        }
+
+        if (strcmp(handler, "__alwf_state_sync") == 0)
+        {
+            auto store = doc.FindMember("store");
+            if (store != doc.MemberEnd() && store->value.IsString())
+                sync_state_store(store->value.GetString(), current);
+            return;
+        }
+
+        if (ctx->handler_router)
+        {
+            auto it = ctx->handler_router->find(handler);
+            if (it != ctx->handler_router->end())
+            {
+                EndpointStats *stats = handler_stats(EndpointKind::handler, handler);
+                ActivityScope activity(stats);
+                const auto start = MetricsClock::now();
+                try
+                {
+                    it->second(doc);
+                }
+                catch (...)
+                {
+                    stats->errors.fetch_add(1, std::memory_order_relaxed);
+                    stats->latency.record(elapsed_us(start));
+                    throw;
+                }
+                stats->latency.record(elapsed_us(start));
+                stats->bytes.fetch_add(strlen(json), std::memory_order_relaxed);
+                return;
+            }
+        }
+        LOG_ERROR("No such handler: %s", handler);
+    }
 } // namespace alwf
\ No newline at end of file
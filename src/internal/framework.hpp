@@ -1,10 +1,17 @@
 #pragma once
 
 #include <alwf/alwf.hpp>
+#include <alwf/metrics.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 #ifdef _WIN32
     #include <awin/window.hpp>
 using PLATFORM_WINDOW = awin::Window;
+#elif defined(ALWF_HEADLESS)
+using PLATFORM_WINDOW = void;
 #else
     #include <gtk/gtk.h>
 using PLATFORM_WINDOW = GtkWidget;
@@ -12,15 +19,342 @@ using PLATFORM_WINDOW = GtkWidget;
 
 namespace alwf
 {
-    void init_web_view(PLATFORM_WINDOW *window);
+    // The platform layer keeps one web view per window, all on a shared web context. Main thread only.
+    void init_web_view(WindowId id, PLATFORM_WINDOW *window, const char *path);
+    void destroy_web_view(WindowId id);
     void destroy_platform();
     void on_resize(PLATFORM_WINDOW *window, acul::point2D<i32> size);
-    void on_move();
+    void on_move(PLATFORM_WINDOW *window);
 
-    IResponse *load_static_file(const acul::string &path);
+    // Sets *cached to whether the file was already in the file cache
+    IResponse *load_static_file(const acul::string &path, bool *cached = nullptr);
+    // Reads a file of the static folder without touching the cache; safe to call off the main thread
+    IResponse *load_static_file_from_disk(const char *folder, const acul::string &path);
+    // Starts warming the page's Router::assets and returns its preload Link header, or null
+    const char *prepare_page_assets(const Request &req);
+    // Starts reading a page's Router::assets into the file cache in the background
+    void prewarm_page_assets(const char *path);
+    void destroy_page_assets();
 
     void parse_request_url(const acul::string &uri, Request &request);
 
+    // "GET", "POST", "PUT" or "DELETE". parse_method() is case-sensitive, as HTTP methods are.
+    const char *method_name(Method method);
+    bool parse_method(const char *name, Method &method);
+
+    // A start or end tag found in rendered HTML. Offsets index the scanned string.
+    struct HtmlTag
+    {
+        size_t begin; // '<'
+        size_t end;   // past '>'
+        size_t name, name_size;
+        size_t attrs; // start of the attribute list
+        bool closing;
+    };
+
+    // Minimal HTML tokenizer for fragment extraction and link prerendering. Finds the next tag at or after `from`,
+    // skipping comments, doctypes and literal '<'. Continue from after_html_tag(), which also skips the bodies of
+    // raw-text elements (script, style, textarea, title, template).
+    bool next_html_tag(const acul::string &html, size_t from, HtmlTag &tag);
+    size_t after_html_tag(const acul::string &html, const HtmlTag &tag);
+    // Names are matched case-insensitively and must be given in lowercase
+    bool html_tag_is(const acul::string &html, const HtmlTag &tag, const char *name);
+    bool html_attribute(const acul::string &html, const HtmlTag &tag, const char *name, acul::string &value);
+    // Calls fn with the value of `attr` on every `tag` start tag
+    void for_each_html_attribute(const acul::string &html, const char *tag, const char *attr,
+                                 const std::function<void(acul::string &&)> &fn);
+
+    enum class DispatchKind
+    {
+        not_found,
+        owned,  // the caller releases res
+        cached,  // res belongs to the file cache
+        stream,  // the backend opens a push stream
+        deferred // a coroutine route is suspended; the result arrives through pending->finish
+    };
+
+    class PendingResponse;
+
+    struct DispatchResult
+    {
+        DispatchKind kind = DispatchKind::not_found;
+        IResponse *res = nullptr;
+        const char *link = nullptr; // preload Link header for pages
+        PendingResponse *pending = nullptr;
+        u16 status = 200; // 500 for error responses; the web view backends cannot send it
+    };
+
+    // Returned by an async_route() handler that suspended. The dispatcher hooks its post-processing into
+    // on_complete; the backend keeps the native request alive and answers it from finish with an owned result.
+    // async_route() releases it once on_complete returns. Main thread only.
+    class PendingResponse final : public IResponse
+    {
+    public:
+        std::function<void(IResponse *, std::exception_ptr)> on_complete;
+        std::function<void(const DispatchResult &)> finish;
+
+        // Set when the coroutine completed before on_complete was hooked
+        bool done = false;
+        IResponse *result = nullptr;
+        std::exception_ptr error;
+
+        PendingResponse() : IResponse(nullptr) {}
+
+        const char *data() const override { return nullptr; }
+        size_t size() const override { return 0; }
+    };
+
+    // Platform-neutral handling of app scheme requests: blobs, the push stream, route handlers and static files
+    DispatchResult dispatch_request(const Request &req);
+    IResponse *emit_error(const Request &req, const char *err);
+    acul::string find_header(const HeaderMap &headers, const char *name);
+    // Whether the request expects the handler's JSON branch: Accept names application/json, or X-Requested-With is
+    // fetch or XMLHttpRequest. Caches that store either form key on this too.
+    bool wants_json(const Request &req);
+    // POST /__alwf/batch: dispatches a JSON array of sub-requests and frames their responses into one. Returns a
+    // PendingResponse while coroutine routes among them are suspended, or null for a malformed batch.
+    IResponse *dispatch_batch(const Request &req);
+
+    void dispatch_message(const char *json);
+    // Replaces a full page with the elements requested through the X-Alwf-Fragment header. Takes ownership of res.
+    IResponse *extract_fragments(const Request &req, IResponse *res);
+    void send_raw_to_frontend(const acul::string &json, WindowId window = all_windows);
+    void post_to_main(std::function<void()> &&task);
+    void post_idle(std::function<void()> &&task);
+    // Runs the task on the main thread after ms milliseconds. Main thread only.
+    void post_delayed(u32 ms, std::function<void()> &&task);
+    void stop_background_pool();
+#ifdef _WIN32
+    void dispatch_main_queue();
+#endif
+
+    // Open windows. The count is thread-safe, the ids are main thread only.
+    size_t window_count();
+    acul::vector<WindowId> window_ids();
+
+    WindowId swap_current_window(WindowId id);
+
+    // Per-window languages (l10n.cpp). swap_current_window() enters the window's language for tr().
+    void enter_window_language(WindowId window);
+    void forget_window_language(WindowId window);
+
+    // Marks the window a message or request came from for current_window()
+    struct WindowScope
+    {
+        WindowId prev;
+
+        explicit WindowScope(WindowId id) : prev(swap_current_window(id)) {}
+        ~WindowScope() { swap_current_window(prev); }
+    };
+
+    void begin_call(const char *handler, const rapidjson::Document &doc);
+    void cancel_call(const char *js_id);
+    // Forgets the unanswered calls of a window that closed or started loading a new page
+    void drop_window_calls(WindowId window);
+
+    struct Blob
+    {
+        acul::vector<char> data;
+        const char *content_type;
+        std::atomic<u32> refs{1};
+    };
+
+    Blob *make_blob(acul::vector<char> &&data, const char *content_type);
+    inline void retain_blob(Blob *blob) { blob->refs.fetch_add(1, std::memory_order_relaxed); }
+    void unref_blob(Blob *blob);
+
+    class BlobResponse final : public IResponse
+    {
+    public:
+        Blob *blob;
+
+        explicit BlobResponse(Blob *blob) : IResponse(blob->content_type), blob(blob) { retain_blob(blob); }
+        ~BlobResponse() override { unref_blob(blob); }
+
+        const char *data() const override { return blob->data.data(); }
+        size_t size() const override { return blob->data.size(); }
+    };
+
+    IResponse *acquire_blob_response(const acul::string &path);
+    void destroy_blobs();
+    size_t blob_bytes();
+
+    // Newline-delimited JSON frames streamed to a window's page over a single long-lived scheme request
+    struct PushChannel
+    {
+        WindowId window;
+        std::mutex lock;
+        std::condition_variable cv;
+        acul::string buffer;
+        size_t offset = 0;
+        bool closed = false;
+        std::atomic<u32> refs{1};
+    };
+
+    // Replaces the window's previous channel, if any
+    PushChannel *open_push_channel(WindowId window);
+    bool has_push_channel(WindowId window);
+    void close_push_channel(PushChannel *channel);
+    void unref_push_channel(PushChannel *channel);
+    // Returns the number of bytes read, 0 once the channel is closed and drained, -1 on timeout
+    long read_push_channel(PushChannel *channel, char *dst, size_t len, u32 timeout_ms);
+    void destroy_push_channel();
+    size_t push_pending_bytes();
+    // False when the message went through the web view fallback for at least one window
+    bool push_raw_to_frontend(acul::string &&json, WindowId window = all_windows);
+
+    // Sends the store's snapshot to the window, after broadcasting any pending operations
+    void sync_state_store(const char *name, WindowId window);
+
+    // Serves the router, handlers and static files over HTTP/1.1 on 127.0.0.1. Requests are dispatched on the main thread.
+    // Only built into debug builds, or release builds with ALWF_HTTP_TRANSPORT defined.
+    bool start_http_transport(u16 port, u32 threads, const char *token);
+    void stop_http_transport();
+
+    // Worker processes for worker_route() and worker_handler() jobs, each driven by a supervising thread
+    void start_worker_pool(u32 processes, u32 timeout_ms);
+    void stop_worker_pool();
+
+    // Takes a still-fresh idle-time render of the requested page out of the cache, or returns null
+    IResponse *take_prerendered(const Request &req);
+    // Queues the page's internal links for idle-time prerendering when Options::prerender_links is set
+    void note_served_page(const Request &req, const IResponse *res);
+    void destroy_prerender_cache();
+    // Main thread only
+    size_t prerender_cache_bytes();
+
+    // Results of GET routes with a Router::cache policy. Returns a copy of a fresh result, a PendingResponse that
+    // joins an identical coroutine route in flight, or null when the handler has to run. Main thread only.
+    IResponse *lookup_route_cache(const Request &req);
+    // Keeps a copy of the handler's result, or tracks its PendingResponse as in flight
+    void store_route_result(const Request &req, IResponse *res);
+    // Completes the requests that joined the suspended route and caches its result
+    void settle_route_flight(PendingResponse *leader, const IResponse *res, std::exception_ptr error);
+    void destroy_route_cache();
+    size_t route_cache_bytes();
+
+    // Memory pressure. The window backends report minimize/restore and closed windows as visible; the web views go
+    // into low-memory mode once every window is hidden. The platform layer watches for system low-memory signals.
+    void on_window_visibility(WindowId window, bool visible);
+    void set_web_memory_low(bool low);
+    void collect_web_garbage();
+
+    using MetricsClock = std::chrono::steady_clock;
+
+    inline u64 elapsed_us(MetricsClock::time_point since)
+    {
+        return (u64)std::chrono::duration_cast<std::chrono::microseconds>(MetricsClock::now() - since).count();
+    }
+
+    // Log-linear latency histogram in microseconds, HDR style: 8 linear sub-buckets per power of two keep the
+    // relative error under 12.5% up to ~71 minutes. Recording is lock-free and safe from any thread.
+    struct LatencyHistogram
+    {
+        static constexpr u32 sub_bits = 3;
+        static constexpr u32 bucket_count = (32 - sub_bits + 1) << sub_bits;
+
+        std::atomic<u64> buckets[bucket_count]{};
+        std::atomic<u64> sum_us{0};
+        std::atomic<u64> max_us{0};
+
+        void record(u64 us);
+        void reset();
+        LatencySummary summarize() const;
+    };
+
+    struct EndpointStats
+    {
+        EndpointKind kind;
+        acul::string name;
+        std::atomic<u64> errors{0};
+        std::atomic<u64> bytes{0};
+        std::atomic<u64> cache_hits{0};
+        std::atomic<u64> cache_misses{0};
+        std::atomic<u64> stalls{0};
+        std::atomic<u64> stall_ms{0};
+        LatencyHistogram latency;
+        LatencyHistogram completion;
+
+        EndpointStats(EndpointKind kind, acul::string &&name) : kind(kind), name(std::move(name)) {}
+    };
+
+    // Lookups are main thread only and never fail; the stats live until exit
+    EndpointStats *route_stats(Method method, const acul::string &path);
+    EndpointStats *handler_stats(EndpointKind kind, const char *name);
+    EndpointStats *aggregate_stats(EndpointKind kind);
+
+    // Marks the endpoint running on the main thread so the watchdog can attribute stalls to it
+    EndpointStats *swap_activity(EndpointStats *stats);
+
+    struct ActivityScope
+    {
+        EndpointStats *prev;
+
+        explicit ActivityScope(EndpointStats *stats) : prev(swap_activity(stats)) {}
+        ~ActivityScope() { swap_activity(prev); }
+    };
+
+    // Watches a main-loop heartbeat from its own thread and logs stalls longer than threshold_ms
+    void start_watchdog(u32 threshold_ms, bool sample_stack);
+    void stop_watchdog();
+    void reset_stall_stats();
+    // Platform stack sampling of the main thread; init runs on the main thread. False where unsupported.
+    void init_stack_sampler();
+    bool sample_main_stack(acul::string &out);
+
+    // Startup trace written as Chrome trace-event JSON to Options::trace_file. Recording stops and the file is
+    // written when the page reports its first paint, or at shutdown. Thread-safe.
+    void start_startup_trace(const char *path);
+    bool startup_tracing();
+    void trace_span(acul::string &&name, MetricsClock::time_point start);
+    void trace_instant(acul::string &&name, acul::string &&args = {});
+    void finish_startup_trace();
+
+    struct TraceScope
+    {
+        const char *name;
+        MetricsClock::time_point start = MetricsClock::now();
+
+        explicit TraceScope(const char *name) : name(name) {}
+        ~TraceScope() { trace_span(name, start); }
+    };
+
+    // Access log: fixed-size records pushed into a preallocated lock-free ring on the request path and formatted
+    // by a background writer into Options::access_log_file. Returns false, leaving the log off, if the file cannot be
+    // opened.
+    bool start_access_log(const char *path, u32 capacity, u32 sample, size_t max_bytes);
+    void stop_access_log();
+    bool access_log_active();
+    void log_access(const Request &req, u16 status, u64 latency_us, size_t size, const char *error);
+
+    // Opt-in recording of app scheme requests, inbound messages and outbound messages (Options::capture_file),
+    // replayed headlessly by alwf_replay. Thread-safe.
+    enum class CaptureKind : u8
+    {
+        request = 1,
+        message,
+        outbound
+    };
+
+    struct CaptureRecord
+    {
+        CaptureKind kind;
+        u64 ts_us; // since the start of the capture
+        Method method = Method::get;
+        acul::string path;
+        acul::string query;
+        acul::string body;
+        HeaderMap headers;
+        acul::string json;
+    };
+
+    bool start_capture(const char *path);
+    void stop_capture();
+    bool capture_active();
+    void capture_request(const Request &req);
+    void capture_message(CaptureKind kind, const char *json, size_t len);
+    bool read_capture(const char *path, acul::vector<CaptureRecord> &records);
+
     using FileCache = acul::hashmap<acul::string, acul::unique_ptr<IResponse>>;
 
     extern struct Context
@@ -28,6 +362,16 @@ namespace alwf
         const char *static_folder;
         Router *router;
         HandlerRouter *handler_router;
+        CallRouter *call_router;
+        const StringTable *strings;
+        u32 call_timeout_ms;
+        u32 blob_ttl_ms;
+        bool prerender_links;
+        size_t prerender_budget;
+        u32 prerender_ttl_ms;
+        size_t memory_low_water;
+        u32 web_memory_limit_mb;
         FileCache file_cache;
+        size_t file_cache_bytes = 0;
     } *ctx;
 } // namespace alwf
\ No newline at end of file
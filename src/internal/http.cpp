@@ -0,0 +1,510 @@
+#include <acul/log.hpp>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>
+#include "framework.hpp"
+#include "net.hpp"
+
+namespace alwf
+{
+#if !defined(NDEBUG) || defined(ALWF_HTTP_TRANSPORT)
+    static constexpr size_t max_header_size = 64 << 10;
+    static constexpr size_t max_body_size = 64 << 20;
+
+    struct HttpConnection
+    {
+        socket_t fd;
+        acul::string in;
+        acul::string out;
+        size_t out_offset = 0;
+        bool in_flight = false; // a request is being handled on the main thread
+        bool close_after = false;
+        bool closed = false;
+    };
+
+    // Workers own their connections; responses come back from the main thread through `done` and a wake-up datagram
+    struct HttpWorker
+    {
+        std::thread thread;
+        socket_t wake_rx = INVALID_SOCKET;
+        socket_t wake_tx = INVALID_SOCKET;
+        std::mutex lock;
+        acul::vector<std::pair<u64, acul::string>> done;
+        acul::hashmap<u64, HttpConnection> connections;
+        u64 next_id = 0;
+    };
+
+    struct HttpPending
+    {
+        u64 connection;
+        Request req;
+        HeaderMap headers;
+        bool keep_alive;
+    };
+
+    static struct HttpServer
+    {
+        socket_t listener = INVALID_SOCKET;
+        u16 port = 0;
+        acul::string token; // required from every client, see authorize()
+        std::atomic<bool> running{false};
+        acul::vector<std::shared_ptr<HttpWorker>> workers;
+    } *server = nullptr;
+
+    static const char *status_text(int status)
+    {
+        switch (status)
+        {
+            case 200:
+                return "OK";
+            case 204:
+                return "No Content";
+            case 400:
+                return "Bad Request";
+            case 403:
+                return "Forbidden";
+            case 404:
+                return "Not Found";
+            case 413:
+                return "Payload Too Large";
+            case 431:
+                return "Request Header Fields Too Large";
+            case 500:
+                return "Internal Server Error";
+            case 501:
+                return "Not Implemented";
+            default:
+                return "Service Unavailable";
+        }
+    }
+
+    static acul::string make_http_response(int status, const IResponse *res, bool keep_alive, const char *link = nullptr)
+    {
+        const size_t size = res ? res->size() : 0;
+        acul::string out = acul::format("HTTP/1.1 %d %s\r\nContent-Length: %zu\r\nConnection: %s\r\n", status,
+                                        status_text(status), size, keep_alive ? "keep-alive" : "close");
+        if (res && res->content_type) out.append(acul::format("Content-Type: %s\r\n", res->content_type));
+        if (link) out.append(acul::format("Link: %s\r\n", link));
+        out.append("\r\n");
+        if (size) out.append(res->data(), res->data() + size);
+        return out;
+    }
+
+    static void complete(const std::shared_ptr<HttpWorker> &worker, u64 connection, acul::string &&response)
+    {
+        // Requests still queued on the main thread when the transport stops are dropped
+        if (!server || !server->running.load(std::memory_order_acquire)) return;
+        {
+            std::lock_guard<std::mutex> lock(worker->lock);
+            worker->done.emplace_back(connection, std::move(response));
+        }
+        char wake = 1;
+        send(worker->wake_tx, &wake, 1, 0);
+    }
+
+    // Also answers completed coroutine routes, so handler errors keep their 500 on both paths
+    static acul::string make_dispatch_response(const DispatchResult &result, bool keep_alive)
+    {
+        acul::string response;
+        switch (result.kind)
+        {
+            case DispatchKind::owned:
+                response = make_http_response(result.status, result.res, keep_alive, result.link);
+                acul::release(result.res);
+                break;
+            case DispatchKind::cached:
+                response = make_http_response(result.status, result.res, keep_alive);
+                break;
+            default:
+                // The push stream needs the page's bridge and is not served over HTTP
+                response = make_http_response(404, nullptr, keep_alive);
+                break;
+        }
+        return response;
+    }
+
+    // Runs on the main thread, where route handlers and the caches they use live
+    static void handle_request(const std::shared_ptr<HttpWorker> &worker, const std::shared_ptr<HttpPending> &pending)
+    {
+        Request &req = pending->req;
+        if (!ctx)
+        {
+            complete(worker, pending->connection, make_http_response(503, nullptr, false));
+            return;
+        }
+
+        if (req.method == Method::post && req.path == "/__alwf/message")
+        {
+            dispatch_message(req.body.c_str());
+            complete(worker, pending->connection, make_http_response(204, nullptr, pending->keep_alive));
+            return;
+        }
+
+        DispatchResult result = dispatch_request(req);
+        if (result.kind == DispatchKind::deferred)
+        {
+            // A coroutine route suspended; the connection waits, and pending keeps the parsed headers alive
+            result.pending->finish = [worker, pending](const DispatchResult &done) {
+                complete(worker, pending->connection, make_dispatch_response(done, pending->keep_alive));
+            };
+            return;
+        }
+        complete(worker, pending->connection, make_dispatch_response(result, pending->keep_alive));
+    }
+
+    // Removes alwf_token=<token> from the query so it never reaches routes or cache keys, and returns its value
+    static acul::string take_query_token(acul::string &query)
+    {
+        static constexpr char key[] = "alwf_token=";
+        constexpr size_t key_size = sizeof(key) - 1;
+        for (size_t start = 0; start < query.size();)
+        {
+            size_t amp = query.find('&', start);
+            if (amp == acul::string::npos) amp = query.size();
+            if (query.compare(start, key_size, key) != 0)
+            {
+                start = amp + 1;
+                continue;
+            }
+            acul::string token = query.substr(start + key_size, amp - start - key_size);
+            // Drop the parameter along with one of its separators
+            if (amp < query.size()) query.erase(start, amp + 1 - start);
+            else query.erase(start > 0 ? start - 1 : 0);
+            return token;
+        }
+        return {};
+    }
+
+    static bool is_local_authority(const acul::string &value, const char *prefix)
+    {
+        for (const char *host : {"127.0.0.1", "localhost"})
+            if (acul::to_lower(value) == acul::format("%s%s:%u", prefix, host, (unsigned)server->port)) return true;
+        return false;
+    }
+
+    // Any local process or web page can reach the port, so requests must name this server in Host (against DNS
+    // rebinding), carry no foreign Origin, and present the per-launch token in X-Alwf-Token or ?alwf_token=.
+    static bool authorize(HttpPending &pending)
+    {
+        if (!is_local_authority(find_header(pending.headers, "host"), "")) return false;
+        acul::string origin = find_header(pending.headers, "origin");
+        if (!origin.empty() && !is_local_authority(origin, "http://")) return false;
+
+        acul::string token = take_query_token(pending.req.query);
+        if (token.empty()) token = find_header(pending.headers, "x-alwf-token");
+        return !token.empty() && token == server->token;
+    }
+
+    // Parses one request from the connection's input. Returns 0 when more input is needed, 200 when a request was
+    // taken, or the error status to answer with.
+    static int parse_http_request(HttpConnection &c, HttpPending &pending)
+    {
+        size_t header_end = c.in.find("\r\n\r\n");
+        if (header_end == acul::string::npos) return c.in.size() > max_header_size ? 431 : 0;
+
+        size_t line_end = c.in.find("\r\n");
+        acul::string line = c.in.substr(0, line_end);
+        size_t sp1 = line.find(' ');
+        size_t sp2 = sp1 == acul::string::npos ? sp1 : line.find(' ', sp1 + 1);
+        if (sp2 == acul::string::npos) return 400;
+        acul::string version = line.substr(sp2 + 1);
+        acul::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        if (!parse_method(line.substr(0, sp1).c_str(), pending.req.method)) return 501;
+
+        for (size_t pos = line_end + 2; pos < header_end;)
+        {
+            size_t next = c.in.find("\r\n", pos);
+            size_t colon = c.in.find(':', pos);
+            if (colon != acul::string::npos && colon < next)
+            {
+                size_t value = colon + 1;
+                while (value < next && (c.in[value] == ' ' || c.in[value] == '\t')) ++value;
+                pending.headers[acul::to_lower(c.in.substr(pos, colon - pos))] = c.in.substr(value, next - value);
+            }
+            pos = next + 2;
+        }
+
+        if (!find_header(pending.headers, "transfer-encoding").empty()) return 501;
+        size_t body_size = 0;
+        acul::string length = find_header(pending.headers, "content-length");
+        if (!length.empty()) body_size = strtoull(length.c_str(), nullptr, 10);
+        if (body_size > max_body_size) return 413;
+        if (c.in.size() < header_end + 4 + body_size) return 0;
+
+        pending.req.body = c.in.substr(header_end + 4, body_size);
+        c.in.erase(0, header_end + 4 + body_size);
+
+        // Absolute-form targets carry the host; only the path is routed
+        if (target.find("http://") == 0)
+        {
+            size_t slash = target.find('/', 7);
+            target = slash == acul::string::npos ? acul::string("/") : target.substr(slash);
+        }
+        parse_request_url(target, pending.req);
+        pending.req.request_ctx = nullptr;
+        if (!authorize(pending)) return 403;
+
+        acul::string connection = acul::to_lower(find_header(pending.headers, "connection"));
+        pending.keep_alive = version == "HTTP/1.1" ? connection != "close" : connection == "keep-alive";
+        return 200;
+    }
+
+    static void flush(HttpConnection &c)
+    {
+        while (c.out_offset < c.out.size())
+        {
+            auto n = send(c.fd, c.out.c_str() + c.out_offset, (int)(c.out.size() - c.out_offset), send_flags);
+            if (n > 0)
+            {
+                c.out_offset += (size_t)n;
+                continue;
+            }
+            if (n < 0 && would_block()) return;
+            c.closed = true;
+            return;
+        }
+        c.out.clear();
+        c.out_offset = 0;
+        if (c.close_after && !c.in_flight) c.closed = true;
+    }
+
+    static void process_input(const std::shared_ptr<HttpWorker> &worker, u64 id, HttpConnection &c)
+    {
+        if (c.in_flight || c.close_after || c.in.empty()) return;
+
+        auto pending = std::make_shared<HttpPending>();
+        pending->connection = id;
+        int status = parse_http_request(c, *pending);
+        if (status == 0) return;
+        if (status != 200)
+        {
+            c.out.append(make_http_response(status, nullptr, false));
+            c.close_after = true;
+            flush(c);
+            return;
+        }
+
+        pending->req.headers = &pending->headers;
+        c.in_flight = true;
+        c.close_after = !pending->keep_alive;
+        post_to_main([worker, pending]() { handle_request(worker, pending); });
+    }
+
+    static void accept_connections(HttpWorker &worker)
+    {
+        for (;;)
+        {
+            socket_t fd = accept(server->listener, nullptr, nullptr);
+            if (fd == INVALID_SOCKET) return;
+            set_nonblocking(fd);
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char *)&on, sizeof(on));
+            HttpConnection c;
+            c.fd = fd;
+            worker.connections.emplace(worker.next_id++, std::move(c));
+        }
+    }
+
+    static void take_responses(const std::shared_ptr<HttpWorker> &worker)
+    {
+        char buf[256];
+        while (recv(worker->wake_rx, buf, sizeof(buf), 0) > 0);
+
+        acul::vector<std::pair<u64, acul::string>> done;
+        {
+            std::lock_guard<std::mutex> lock(worker->lock);
+            done.swap(worker->done);
+        }
+        for (auto &[id, response] : done)
+        {
+            auto it = worker->connections.find(id);
+            if (it == worker->connections.end()) continue; // the client went away meanwhile
+            HttpConnection &c = it->second;
+            c.in_flight = false;
+            c.out.append(response);
+            flush(c);
+            process_input(worker, id, c); // pipelined requests
+        }
+    }
+
+    static void read_connection(const std::shared_ptr<HttpWorker> &worker, u64 id, HttpConnection &c)
+    {
+        char buf[16 << 10];
+        for (;;)
+        {
+            auto n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n > 0)
+            {
+                c.in.append(buf, buf + n);
+                continue;
+            }
+            if (n < 0 && would_block()) break;
+            c.closed = true;
+            return;
+        }
+        process_input(worker, id, c);
+    }
+
+    static void run_worker(std::shared_ptr<HttpWorker> worker)
+    {
+        acul::vector<pollfd_t> fds;
+        acul::vector<u64> ids;
+        while (server->running.load(std::memory_order_acquire))
+        {
+            fds.clear();
+            ids.clear();
+            fds.push_back(pollfd_t{server->listener, POLLIN, 0});
+            fds.push_back(pollfd_t{worker->wake_rx, POLLIN, 0});
+            for (auto &[id, c] : worker->connections)
+            {
+                short events = c.in_flight ? 0 : POLLIN;
+                if (c.out_offset < c.out.size()) events |= POLLOUT;
+                fds.push_back(pollfd_t{c.fd, events, 0});
+                ids.push_back(id);
+            }
+
+            if (poll_sockets(fds.data(), fds.size(), 250) <= 0) continue;
+            if (fds[1].revents & POLLIN) take_responses(worker);
+            if (fds[0].revents & POLLIN) accept_connections(*worker);
+
+            for (size_t i = 2; i < fds.size(); ++i)
+            {
+                auto it = worker->connections.find(ids[i - 2]);
+                if (it == worker->connections.end()) continue;
+                HttpConnection &c = it->second;
+                if (fds[i].revents & (POLLERR | POLLNVAL)) c.closed = true;
+                if (!c.closed && (fds[i].revents & (POLLIN | POLLHUP))) read_connection(worker, it->first, c);
+                if (!c.closed && (fds[i].revents & POLLOUT)) flush(c);
+            }
+
+            for (auto it = worker->connections.begin(); it != worker->connections.end();)
+            {
+                if (!it->second.closed)
+                {
+                    ++it;
+                    continue;
+                }
+                close_socket(it->second.fd);
+                it = worker->connections.erase(it);
+            }
+        }
+
+        for (auto &[id, c] : worker->connections) close_socket(c.fd);
+        worker->connections.clear();
+    }
+
+    // A connected pair of loopback datagram sockets: portable wake-up for poll()
+    static bool open_wake_pair(HttpWorker &worker)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+
+        sockaddr_in rx_addr = addr, tx_addr = addr;
+        worker.wake_rx = socket(AF_INET, SOCK_DGRAM, 0);
+        worker.wake_tx = socket(AF_INET, SOCK_DGRAM, 0);
+        if (worker.wake_rx == INVALID_SOCKET || worker.wake_tx == INVALID_SOCKET) return false;
+        if (bind(worker.wake_rx, (sockaddr *)&rx_addr, len) != 0 || bind(worker.wake_tx, (sockaddr *)&tx_addr, len) != 0)
+            return false;
+        getsockname(worker.wake_rx, (sockaddr *)&rx_addr, &len);
+        getsockname(worker.wake_tx, (sockaddr *)&tx_addr, &len);
+        if (connect(worker.wake_rx, (sockaddr *)&tx_addr, len) != 0 || connect(worker.wake_tx, (sockaddr *)&rx_addr, len) != 0)
+            return false;
+        set_nonblocking(worker.wake_rx);
+        set_nonblocking(worker.wake_tx);
+        return true;
+    }
+
+    static void close_worker_sockets(HttpWorker &worker)
+    {
+        if (worker.wake_rx != INVALID_SOCKET) close_socket(worker.wake_rx);
+        if (worker.wake_tx != INVALID_SOCKET) close_socket(worker.wake_tx);
+        worker.wake_rx = worker.wake_tx = INVALID_SOCKET;
+    }
+
+    static acul::string make_token()
+    {
+        std::random_device rd;
+        acul::string token;
+        for (int i = 0; i < 4; ++i) token.append(acul::format("%08x", (unsigned)rd()));
+        return token;
+    }
+
+    bool start_http_transport(u16 port, u32 threads, const char *token)
+    {
+#ifdef _WIN32
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+        server = acul::alloc<HttpServer>();
+        server->port = port;
+        server->token = token && *token ? acul::string(token) : make_token();
+        server->listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (server->listener == INVALID_SOCKET)
+        {
+            stop_http_transport();
+            return false;
+        }
+        int on = 1;
+        setsockopt(server->listener, SOL_SOCKET, SO_REUSEADDR, (const char *)&on, sizeof(on));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // never exposed beyond this machine
+        addr.sin_port = htons(port);
+        if (bind(server->listener, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(server->listener, SOMAXCONN) != 0)
+        {
+            LOG_ERROR("Failed to listen on 127.0.0.1:%u", (unsigned)port);
+            stop_http_transport();
+            return false;
+        }
+        set_nonblocking(server->listener);
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        server->running.store(true, std::memory_order_release);
+        for (u32 i = 0; i < threads; ++i)
+        {
+            auto worker = std::make_shared<HttpWorker>();
+            if (!open_wake_pair(*worker))
+            {
+                close_worker_sockets(*worker);
+                stop_http_transport();
+                return false;
+            }
+            worker->thread = std::thread(run_worker, worker);
+            server->workers.push_back(std::move(worker));
+        }
+        LOG_INFO("Serving HTTP on 127.0.0.1:%u with %u threads, token %s", (unsigned)port, threads,
+                 server->token.c_str());
+        return true;
+    }
+
+    void stop_http_transport()
+    {
+        if (!server) return;
+        server->running.store(false, std::memory_order_release);
+        for (auto &worker : server->workers)
+        {
+            if (worker->thread.joinable()) worker->thread.join();
+            close_worker_sockets(*worker);
+        }
+        server->workers.clear();
+        if (server->listener != INVALID_SOCKET) close_socket(server->listener);
+        acul::release(server);
+        server = nullptr;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+#else
+    bool start_http_transport(u16, u32, const char *)
+    {
+        LOG_WARN("Options::http_port is ignored: release builds need the ALWF_HTTP_TRANSPORT option");
+        return false;
+    }
+
+    void stop_http_transport() {}
+#endif
+} // namespace alwf
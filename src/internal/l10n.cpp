@@ -0,0 +1,70 @@
+#include <alwf/l10n.hpp>
+#include <atomic>
+#include "framework.hpp"
+
+namespace alwf
+{
+    static constexpr u32 no_language = ~0u;
+
+    static std::atomic<u32> language{0};
+    static acul::hashmap<WindowId, u32> window_languages; // main thread only
+    static thread_local u32 scoped_language = no_language;
+    static thread_local u32 window_language = no_language; // kept by enter_window_language() on the main thread
+
+    u32 StringTable::find_language(const acul::string &code) const
+    {
+        for (u32 i = 0; i < language_count; ++i)
+        {
+            size_t len = strlen(languages[i]);
+            if (strncmp(code.c_str(), languages[i], len) != 0) continue;
+            char next = code.c_str()[len];
+            if (next == '\0' || next == '_' || next == '-' || next == '.') return i;
+        }
+        return 0;
+    }
+
+    const char *StringTable::lookup(u32 language, const char *msgid) const
+    {
+        for (u32 i = 0; i < count; ++i)
+            if (strcmp(msgids[i], msgid) == 0) return get(language, i);
+        return msgid;
+    }
+
+    static u32 clamp_language(u32 lang)
+    {
+        return ctx && ctx->strings && lang >= ctx->strings->language_count ? 0 : lang;
+    }
+
+    void set_language(u32 lang) { language.store(clamp_language(lang), std::memory_order_relaxed); }
+
+    void set_window_language(WindowId window, u32 lang)
+    {
+        window_languages[window] = clamp_language(lang);
+        if (window == current_window()) enter_window_language(window);
+    }
+
+    void enter_window_language(WindowId window)
+    {
+        auto it = window_languages.find(window);
+        window_language = it == window_languages.end() ? no_language : it->second;
+    }
+
+    void forget_window_language(WindowId window) { window_languages.erase(window); }
+
+    u32 current_language()
+    {
+        if (scoped_language != no_language) return scoped_language;
+        if (window_language != no_language) return window_language;
+        return language.load(std::memory_order_relaxed);
+    }
+
+    LanguageScope::LanguageScope(u32 lang) : prev(scoped_language) { scoped_language = clamp_language(lang); }
+
+    LanguageScope::~LanguageScope() { scoped_language = prev; }
+
+    const char *tr(u32 id)
+    {
+        assert(ctx && ctx->strings && "Options::strings is not set");
+        return ctx->strings->get(current_language(), id);
+    }
+} // namespace alwf
@@ -23,44 +23,6 @@ namespace alwf
         return Method::get;
     }
 
-    static bool wants_json_from(const Request &req)
-    {
-        auto accept = req.get_header(ACUL_C_STR("Accept"));
-        if (!accept.empty() && acul::find_insensitive_case(accept, "application/json") != acul::string::npos)
-            return true;
-
-        auto xrw = req.get_header(ACUL_C_STR("X-Requested-With"));
-        if (!xrw.empty())
-        {
-            auto ieq = [](const char *a, const char *b) {
-                for (; *a && *b; ++a, ++b)
-                {
-                    unsigned ca = (unsigned char)*a, cb = (unsigned char)*b;
-                    if (tolower(ca) != tolower(cb)) return false;
-                }
-                return *a == 0 && *b == 0;
-            };
-            if (ieq(xrw.c_str(), "fetch") || ieq(xrw.c_str(), "XMLHttpRequest")) return true;
-        }
-        return false;
-    }
-
-    static IResponse *emit_error(const Request &req, const char *err)
-    {
-        LOG_ERROR("%s", err);
-        if (wants_json_from(req))
-        {
-            rapidjson::Document d;
-            d.SetObject();
-            auto &a = d.GetAllocator();
-            d.AddMember("success", false, a);
-            rapidjson::Value e(err, a);
-            d.AddMember("error", e, a);
-            return acul::alloc<JSONResponse>(std::move(d));
-        }
-        else { return acul::alloc<TextResponse>(err, "text/plain"); }
-    }
-
     static void finish_404(WebKitURISchemeRequest *request)
     {
         GError *err = g_error_new_literal(g_quark_from_static_string("alwf"), 404, "Not Found");
@@ -80,8 +42,38 @@ namespace alwf
         g_object_unref(stream);
     }
 
+    // Hands the response over to WebKit without copying; it is released once the stream is consumed.
+    static void finish_with_owned_response(WebKitURISchemeRequest *request, IResponse *res, const char *link = nullptr)
+    {
+        const char *mime = res->content_type ? res->content_type : "application/octet-stream";
+        const size_t size = res->size();
+
+        GBytes *bytes = g_bytes_new_with_free_func(res->data(), size,
+                                                   [](gpointer p) { acul::release(static_cast<IResponse *>(p)); }, res);
+        GInputStream *stream = g_memory_input_stream_new_from_bytes(bytes);
+        g_bytes_unref(bytes);
+
+#if WEBKIT_CHECK_VERSION(2, 36, 0)
+        if (link)
+        {
+            WebKitURISchemeResponse *response = webkit_uri_scheme_response_new(stream, size);
+            webkit_uri_scheme_response_set_content_type(response, mime);
+            SoupMessageHeaders *hdrs = soup_message_headers_new(SOUP_MESSAGE_HEADERS_RESPONSE);
+            soup_message_headers_append(hdrs, "Link", link);
+            webkit_uri_scheme_response_set_http_headers(response, hdrs); // takes ownership
+            webkit_uri_scheme_request_finish_with_response(request, response);
+            g_object_unref(response);
+            g_object_unref(stream);
+            return;
+        }
+#endif
+        webkit_uri_scheme_request_finish(request, stream, size, mime);
+        g_object_unref(stream);
+    }
+
     acul::string Request::get_header(const ACUL_NATIVE_CHAR *header) const
     {
+        if (headers && header) return find_header(*headers, (const char *)header);
         if (!request_ctx || !header) return {};
         auto *hdrs = static_cast<SoupMessageHeaders *>(request_ctx);
         const char *val = soup_message_headers_get_one(hdrs, (const char *)header);
@@ -89,6 +81,34 @@ namespace alwf
         return acul::string(val);
     }
 
+    static WindowId view_window(WebKitWebView *view)
+    {
+        return view ? GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(view), "alwf-window")) : main_window;
+    }
+
+    static void finish_request(WebKitURISchemeRequest *request_raw, const DispatchResult &result, WindowId window)
+    {
+        switch (result.kind)
+        {
+            case DispatchKind::owned:
+                finish_with_owned_response(request_raw, result.res, result.link);
+                break;
+            case DispatchKind::cached:
+                finish_with_response(request_raw, result.res);
+                break;
+            case DispatchKind::stream:
+            {
+                GInputStream *stream = create_push_stream(window);
+                webkit_uri_scheme_request_finish(request_raw, stream, -1, "application/x-ndjson");
+                g_object_unref(stream);
+                break;
+            }
+            default:
+                finish_404(request_raw);
+                break;
+        }
+    }
+
     static void app_scheme_request_cb(WebKitURISchemeRequest *request_raw, gpointer)
     {
         assert(ctx && "Context is not initialized");
@@ -127,59 +147,23 @@ namespace alwf
         }
 #endif
 
-        Router::route_store *store = nullptr;
-        switch (req.method)
-        {
-            case Method::get:
-                store = &ctx->router->get;
-                break;
-            case Method::post:
-                store = &ctx->router->post;
-                break;
-            case Method::put:
-                store = &ctx->router->put;
-                break;
-            case Method::del:
-                store = &ctx->router->del;
-                break;
-            default:
-                store = &ctx->router->get;
-                break;
-        }
-
         parse_request_url(path, req);
 
-        auto it = store->find(req.path);
-        if (it != store->end())
+        const WindowId window = view_window(webkit_uri_scheme_request_get_web_view(request_raw));
+        WindowScope scope(window);
+        DispatchResult result = dispatch_request(req);
+        if (result.kind == DispatchKind::deferred)
         {
-            IResponse *res = nullptr;
-            try
-            {
-                res = it->second(req);
-                if (!res) res = emit_error(req, "Route handler returned null response");
-            }
-            catch (const std::exception &e)
-            {
-                res = emit_error(req, e.what());
-            }
-            catch (...)
-            {
-                res = emit_error(req, "Unknown error");
-            }
-
-            finish_with_response(request_raw, res);
-            acul::release(res);
-            return;
-        }
-
-        if (auto *res = load_static_file(path))
-        {
-            finish_with_response(request_raw, res);
+            // A coroutine route suspended: hold the request, and with it the headers the coroutine reads, until
+            // it completes
+            g_object_ref(request_raw);
+            result.pending->finish = [request_raw, window](const DispatchResult &done) {
+                finish_request(request_raw, done, window);
+                g_object_unref(request_raw);
+            };
             return;
         }
-
-        // 404
-        finish_404(request_raw);
+        finish_request(request_raw, result, window);
     }
 
     static WebKitWebView *on_create_web_view(WebKitWebView *webview, WebKitNavigationAction *nav, gpointer)
@@ -191,23 +175,13 @@ namespace alwf
         return nullptr;
     }
 
-    static void on_js_message(WebKitUserContentManager *mgr, WebKitJavascriptResult *result, gpointer)
+    static void on_js_message(WebKitUserContentManager *mgr, WebKitJavascriptResult *result, gpointer window)
     {
-        assert(ctx && ctx->handler_router);
         JSCValue *value = webkit_javascript_result_get_js_value(result);
         if (!jsc_value_is_string(value)) return;
         char *json_str = jsc_value_to_string(value);
-
-        rapidjson::Document doc;
-        doc.Parse(json_str);
-        if (!doc.HasParseError() && doc.HasMember("handler"))
-        {
-            acul::string handler = doc["handler"].GetString();
-            auto it = ctx->handler_router->find(handler);
-            if (it != ctx->handler_router->end()) it->second(doc);
-            else LOG_ERROR("No such handler: %s", handler.c_str());
-        }
-
+        WindowScope scope(GPOINTER_TO_UINT(window));
+        dispatch_message(json_str);
         g_free(json_str);
     }
 
@@ -235,53 +209,189 @@ namespace alwf
         return TRUE;
     }
 
-    void init_web_view(GtkWidget *window)
+    static void on_load_changed(WebKitWebView *, WebKitLoadEvent event, gpointer window)
     {
-        WebKitUserContentManager *ucm = webkit_user_content_manager_new();
+        if (event == WEBKIT_LOAD_STARTED) drop_window_calls(GPOINTER_TO_UINT(window));
+    }
+
+    static gboolean on_window_state(GtkWidget *, GdkEventWindowState *e, gpointer window)
+    {
+        const auto hidden = (GdkWindowState)(GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN);
+        if (e->changed_mask & hidden)
+            on_window_visibility(GPOINTER_TO_UINT(window), !(e->new_window_state & hidden));
+        return FALSE;
+    }
+
+#if GLIB_CHECK_VERSION(2, 64, 0)
+    static void on_low_memory(GMemoryMonitor *, GMemoryMonitorWarningLevel level, gpointer)
+    {
+        LOG_WARN("Low memory warning, level %d", (int)level);
+        trim_memory();
+    }
+#endif
+
+    static void watch_memory_pressure()
+    {
+#if GLIB_CHECK_VERSION(2, 64, 0)
+        GMemoryMonitor *monitor = g_memory_monitor_dup_default();
+        g_signal_connect(monitor, "low-memory-warning", G_CALLBACK(on_low_memory), nullptr);
+        platform.memory_monitor = G_OBJECT(monitor);
+#endif
+    }
+
+    void set_web_memory_low(bool low)
+    {
+        if (!platform.web_context) return;
+        webkit_web_context_set_cache_model(platform.web_context,
+                                           low ? WEBKIT_CACHE_MODEL_DOCUMENT_VIEWER : WEBKIT_CACHE_MODEL_WEB_BROWSER);
+    }
+
+    void collect_web_garbage()
+    {
+        if (platform.web_context) webkit_web_context_garbage_collect_javascript_objects(platform.web_context);
+    }
+
+#ifndef NDEBUG
+    static gboolean on_devtools_key(GtkWidget *, GdkEventKey *e, gpointer view)
+    {
+        const guint ctrl = (e->state & GDK_CONTROL_MASK);
+        const guint shift = (e->state & GDK_SHIFT_MASK);
+        if (e->keyval == GDK_KEY_F12 || (ctrl && shift && (e->keyval == GDK_KEY_i || e->keyval == GDK_KEY_I)))
+        {
+            webkit_web_inspector_show(webkit_web_view_get_inspector(WEBKIT_WEB_VIEW(view)));
+            return TRUE;
+        }
+        return FALSE;
+    }
+#endif
+
+    // One context for every window: a single web process pool, network process and memory cache
+    static WebKitWebContext *shared_web_context()
+    {
+        if (platform.web_context) return platform.web_context;
+#if WEBKIT_CHECK_VERSION(2, 34, 0)
+        // Applies to web processes started after this call, so it has to precede the context
+        if (ctx->web_memory_limit_mb)
+        {
+            WebKitMemoryPressureSettings *settings = webkit_memory_pressure_settings_new();
+            webkit_memory_pressure_settings_set_memory_limit(settings, ctx->web_memory_limit_mb);
+            webkit_web_context_set_memory_pressure_settings(settings);
+            webkit_memory_pressure_settings_free(settings);
+        }
+#endif
         WebKitWebContext *context = webkit_web_context_new();
+        platform.web_context = context;
+        watch_memory_pressure();
 
         webkit_web_context_register_uri_scheme(
             context, "app", [](WebKitURISchemeRequest *r, gpointer d) { app_scheme_request_cb(r, d); }, nullptr,
             nullptr);
+        return context;
+    }
+
+    void init_web_view(WindowId id, GtkWidget *window, const char *path)
+    {
+        WebKitWebContext *context = shared_web_context();
+        g_signal_connect(window, "window-state-event", G_CALLBACK(on_window_state), GUINT_TO_POINTER(id));
 
+        // Per view, so messages can be traced back to their window
+        WebKitUserContentManager *ucm = webkit_user_content_manager_new();
         webkit_user_content_manager_register_script_message_handler(ucm, "handler");
-        g_signal_connect(ucm, "script-message-received::handler", G_CALLBACK(on_js_message), nullptr);
+        g_signal_connect(ucm, "script-message-received::handler", G_CALLBACK(on_js_message), GUINT_TO_POINTER(id));
 
-        platform.web_view = WEBKIT_WEB_VIEW(
+        WebKitWebView *view = WEBKIT_WEB_VIEW(
             g_object_new(WEBKIT_TYPE_WEB_VIEW, "web-context", context, "user-content-manager", ucm, nullptr));
+        g_object_set_data(G_OBJECT(view), "alwf-window", GUINT_TO_POINTER(id));
+        platform.views[id] = view;
 
-        g_signal_connect(platform.web_view, "decide-policy", G_CALLBACK(on_decide_policy), nullptr);
-        g_signal_connect(platform.web_view, "create", G_CALLBACK(on_create_web_view), nullptr);
-        gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(platform.web_view));
+        g_signal_connect(view, "decide-policy", G_CALLBACK(on_decide_policy), nullptr);
+        g_signal_connect(view, "create", G_CALLBACK(on_create_web_view), nullptr);
+        g_signal_connect(view, "load-changed", G_CALLBACK(on_load_changed), GUINT_TO_POINTER(id));
+        gtk_container_add(GTK_CONTAINER(window), GTK_WIDGET(view));
 
-        webkit_web_view_load_uri(platform.web_view, "app:///");
+        acul::string uri = acul::format("app://%s", path && *path ? path : "/");
+        webkit_web_view_load_uri(view, uri.c_str());
 
 #ifndef NDEBUG
-        g_signal_connect(window, "key-press-event", G_CALLBACK(+[](GtkWidget *, GdkEventKey *e, gpointer) -> gboolean {
-                             const guint ctrl = (e->state & GDK_CONTROL_MASK);
-                             const guint shift = (e->state & GDK_SHIFT_MASK);
-                             if (e->keyval == GDK_KEY_F12 ||
-                                 (ctrl && shift && (e->keyval == GDK_KEY_i || e->keyval == GDK_KEY_I)))
-                             {
-                                 WebKitWebInspector *inspector = webkit_web_view_get_inspector(platform.web_view);
-                                 webkit_web_inspector_show(inspector);
-                                 return TRUE;
-                             }
-                             return FALSE;
-                         }),
-                         nullptr);
+        g_signal_connect(window, "key-press-event", G_CALLBACK(on_devtools_key), view);
 #endif
     }
 
-    void send_json_to_frontend(const rapidjson::Value &json)
+    // The view goes down with its window
+    void destroy_web_view(WindowId id) { platform.views.erase(id); }
+
+    void send_raw_to_frontend(const acul::string &json, WindowId window)
+    {
+        capture_message(CaptureKind::outbound, json.c_str(), json.size());
+        acul::string script = acul::format("window.__alwf_receive(%s);", json.c_str());
+        auto send = [&script](WebKitWebView *view) {
+            webkit_web_view_evaluate_javascript(view, script.c_str(), -1, nullptr, nullptr, nullptr, nullptr, nullptr);
+        };
+        if (window == all_windows)
+        {
+            for (auto &[id, view] : platform.views) send(view);
+            return;
+        }
+        if (auto it = platform.views.find(window); it != platform.views.end()) send(it->second);
+    }
+
+    void send_json_to_window(WindowId id, const rapidjson::Value &json)
     {
         rapidjson::StringBuffer buf;
         rapidjson::Writer<rapidjson::StringBuffer> w(buf);
         json.Accept(w);
-        acul::string script = acul::format("window.__alwf_receive(%s);", buf.GetString());
-        webkit_web_view_evaluate_javascript(platform.web_view, script.c_str(), -1, nullptr, nullptr, nullptr, nullptr,
-                                            nullptr);
+        send_raw_to_frontend(acul::string(buf.GetString(), buf.GetSize()), id);
     }
 
-    void destroy_platform() {};
+    void send_json_to_frontend(const rapidjson::Value &json) { send_json_to_window(all_windows, json); }
+
+    void post_to_main(std::function<void()> &&task)
+    {
+        using Task = std::function<void()>;
+        g_idle_add_full(
+            G_PRIORITY_DEFAULT,
+            [](gpointer data) -> gboolean {
+                (*static_cast<Task *>(data))();
+                return G_SOURCE_REMOVE;
+            },
+            acul::alloc<Task>(std::move(task)), [](gpointer data) { acul::release(static_cast<Task *>(data)); });
+    }
+
+    void post_idle(std::function<void()> &&task)
+    {
+        using Task = std::function<void()>;
+        g_idle_add_full(
+            G_PRIORITY_LOW,
+            [](gpointer data) -> gboolean {
+                (*static_cast<Task *>(data))();
+                return G_SOURCE_REMOVE;
+            },
+            acul::alloc<Task>(std::move(task)), [](gpointer data) { acul::release(static_cast<Task *>(data)); });
+    }
+
+    void post_delayed(u32 ms, std::function<void()> &&task)
+    {
+        using Task = std::function<void()>;
+        g_timeout_add_full(
+            G_PRIORITY_DEFAULT, ms,
+            [](gpointer data) -> gboolean {
+                (*static_cast<Task *>(data))();
+                return G_SOURCE_REMOVE;
+            },
+            acul::alloc<Task>(std::move(task)), [](gpointer data) { acul::release(static_cast<Task *>(data)); });
+    }
+
+    void destroy_platform()
+    {
+#if GLIB_CHECK_VERSION(2, 64, 0)
+        if (platform.memory_monitor)
+        {
+            g_signal_handlers_disconnect_by_func(platform.memory_monitor, (gpointer)on_low_memory, nullptr);
+            g_object_unref(platform.memory_monitor);
+        }
+#endif
+        platform.memory_monitor = nullptr;
+        platform.views.clear();
+        platform.web_context = nullptr;
+    }
 } // namespace alwf
\ No newline at end of file
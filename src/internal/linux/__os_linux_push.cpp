@@ -0,0 +1,61 @@
+#include "../framework.hpp"
+#include "platform.hpp"
+
+namespace alwf
+{
+    struct AlwfPushStream
+    {
+        GInputStream parent_instance;
+        PushChannel *channel;
+    };
+
+    struct AlwfPushStreamClass
+    {
+        GInputStreamClass parent_class;
+    };
+
+    G_DEFINE_TYPE(AlwfPushStream, alwf_push_stream, G_TYPE_INPUT_STREAM)
+
+    // Called by GIO on a worker thread, so blocking here does not stall the main loop
+    static gssize alwf_push_stream_read(GInputStream *stream, void *buffer, gsize count, GCancellable *cancellable,
+                                        GError **error)
+    {
+        auto *self = reinterpret_cast<AlwfPushStream *>(stream);
+        for (;;)
+        {
+            if (g_cancellable_set_error_if_cancelled(cancellable, error)) return -1;
+            long n = read_push_channel(self->channel, static_cast<char *>(buffer), count, 250);
+            if (n >= 0) return n;
+        }
+    }
+
+    static gboolean alwf_push_stream_close(GInputStream *stream, GCancellable *, GError **)
+    {
+        close_push_channel(reinterpret_cast<AlwfPushStream *>(stream)->channel);
+        return TRUE;
+    }
+
+    static void alwf_push_stream_finalize(GObject *object)
+    {
+        auto *self = reinterpret_cast<AlwfPushStream *>(object);
+        close_push_channel(self->channel);
+        unref_push_channel(self->channel);
+        G_OBJECT_CLASS(alwf_push_stream_parent_class)->finalize(object);
+    }
+
+    static void alwf_push_stream_class_init(AlwfPushStreamClass *klass)
+    {
+        G_OBJECT_CLASS(klass)->finalize = alwf_push_stream_finalize;
+        G_INPUT_STREAM_CLASS(klass)->read_fn = alwf_push_stream_read;
+        G_INPUT_STREAM_CLASS(klass)->close_fn = alwf_push_stream_close;
+    }
+
+    static void alwf_push_stream_init(AlwfPushStream *self) { self->channel = nullptr; }
+
+    GInputStream *create_push_stream(WindowId window)
+    {
+        auto *self = static_cast<AlwfPushStream *>(g_object_new(alwf_push_stream_get_type(), nullptr));
+        self->channel = open_push_channel(window);
+        return G_INPUT_STREAM(self);
+    }
+} // namespace alwf
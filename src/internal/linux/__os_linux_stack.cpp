@@ -0,0 +1,53 @@
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <thread>
+#include "../framework.hpp"
+
+namespace alwf
+{
+    static pthread_t main_thread;
+    static int sample_signal = 0;
+    static void *frames[64];
+    static std::atomic<int> frame_count{-1};
+
+    static void on_sample_signal(int) { frame_count.store(backtrace(frames, 64), std::memory_order_release); }
+
+    void init_stack_sampler()
+    {
+        if (sample_signal) return;
+        main_thread = pthread_self();
+        // The first backtrace() call loads libgcc, which must not happen inside the signal handler
+        void *warmup[1];
+        backtrace(warmup, 1);
+
+        sample_signal = SIGRTMIN + 3;
+        struct sigaction sa{};
+        sa.sa_handler = on_sample_signal;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(sample_signal, &sa, nullptr);
+    }
+
+    bool sample_main_stack(acul::string &out)
+    {
+        if (!sample_signal) return false;
+        frame_count.store(-1, std::memory_order_relaxed);
+        if (pthread_kill(main_thread, sample_signal) != 0) return false;
+        for (int i = 0; i < 100 && frame_count.load(std::memory_order_acquire) < 0; ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        const int n = frame_count.load(std::memory_order_acquire);
+        if (n <= 0) return false;
+        char **symbols = backtrace_symbols(frames, n);
+        if (!symbols) return false;
+        // Skip the signal handler and the kernel trampoline
+        for (int i = 2; i < n; ++i)
+        {
+            out.append(symbols[i]);
+            out.push_back('\n');
+        }
+        free(symbols);
+        return true;
+    }
+} // namespace alwf
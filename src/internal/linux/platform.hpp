@@ -1,11 +1,16 @@
 #pragma once
 
+#include <alwf/alwf.hpp>
 #include <webkit2/webkit2.h>
 
 namespace alwf
 {
     extern struct LinuxPlatformData
     {
-        WebKitWebView *web_view = nullptr;
+        WebKitWebContext *web_context = nullptr; // shared by every window's view
+        GObject *memory_monitor = nullptr;
+        acul::hashmap<WindowId, WebKitWebView *> views;
     } platform;
+
+    GInputStream *create_push_stream(WindowId window);
 } // namespace alwf
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <acul/log.hpp>
+#include <algorithm>
+#include <mutex>
+#include "framework.hpp"
+
+namespace alwf
+{
+    // Never destroyed: ViewCache instances with static storage unregister during static destruction
+    static std::mutex &consumers_lock()
+    {
+        static auto *lock = new std::mutex;
+        return *lock;
+    }
+
+    static acul::hashmap<u64, MemoryConsumer> &consumers()
+    {
+        static auto *map = new acul::hashmap<u64, MemoryConsumer>;
+        return *map;
+    }
+
+    static u64 next_consumer_id = 1;
+    static acul::vector<WindowId> hidden_windows;
+    static bool web_memory_low = false;
+
+    u64 add_memory_consumer(MemoryConsumer &&consumer)
+    {
+        std::lock_guard<std::mutex> lock(consumers_lock());
+        const u64 id = next_consumer_id++;
+        consumers().emplace(id, std::move(consumer));
+        return id;
+    }
+
+    void remove_memory_consumer(u64 id)
+    {
+        std::lock_guard<std::mutex> lock(consumers_lock());
+        consumers().erase(id);
+    }
+
+    MemoryUsage memory_usage()
+    {
+        MemoryUsage usage{};
+        if (ctx)
+        {
+            usage.static_cache = ctx->file_cache_bytes;
+            usage.prerender_cache = prerender_cache_bytes();
+            usage.route_cache = route_cache_bytes();
+        }
+        {
+            std::lock_guard<std::mutex> lock(consumers_lock());
+            for (auto &[id, consumer] : consumers())
+                if (consumer.usage) usage.view_caches += consumer.usage();
+        }
+        usage.blobs = blob_bytes();
+        usage.push_pending = push_pending_bytes();
+        return usage;
+    }
+
+    // Largest files go first: they free the most for the fewest reloads
+    static void trim_file_cache(size_t low_water)
+    {
+        if (ctx->file_cache_bytes <= low_water) return;
+        acul::vector<std::pair<size_t, acul::string>> entries;
+        entries.reserve(ctx->file_cache.size());
+        for (auto &[path, res] : ctx->file_cache) entries.emplace_back(res->size(), path);
+        std::sort(entries.begin(), entries.end(), [](auto &a, auto &b) { return a.first > b.first; });
+        for (auto &[size, path] : entries)
+        {
+            if (ctx->file_cache_bytes <= low_water) break;
+            ctx->file_cache.erase(path);
+            ctx->file_cache_bytes -= size;
+        }
+    }
+
+    void trim_memory()
+    {
+        if (!ctx) return;
+        const MemoryUsage before = memory_usage();
+        trim_file_cache(ctx->memory_low_water);
+        destroy_prerender_cache();
+        destroy_route_cache();
+        {
+            std::lock_guard<std::mutex> lock(consumers_lock());
+            for (auto &[id, consumer] : consumers())
+                if (consumer.trim) consumer.trim();
+        }
+        collect_web_garbage();
+        const MemoryUsage after = memory_usage();
+        LOG_INFO("Trimmed caches: static %zu -> %zu bytes, prerender %zu -> %zu, routes %zu -> %zu, views %zu -> %zu",
+                 before.static_cache, after.static_cache, before.prerender_cache, after.prerender_cache,
+                 before.route_cache, after.route_cache, before.view_caches, after.view_caches);
+    }
+
+    void on_window_visibility(WindowId window, bool visible)
+    {
+        auto it = std::find(hidden_windows.begin(), hidden_windows.end(), window);
+        if (visible && it != hidden_windows.end()) hidden_windows.erase(it);
+        else if (!visible && it == hidden_windows.end()) hidden_windows.push_back(window);
+
+        // The caches are shared, so they are only worth shedding once nothing is on screen
+        const bool low = !hidden_windows.empty() && hidden_windows.size() >= window_count();
+        if (low == web_memory_low) return;
+        web_memory_low = low;
+        if (low) trim_memory();
+        set_web_memory_low(low);
+    }
+} // namespace alwf
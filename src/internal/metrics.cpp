@@ -0,0 +1,249 @@
+#include <bit>
+#include <mutex>
+#include "framework.hpp"
+
+namespace alwf
+{
+    static constexpr u64 linear_buckets = 1u << LatencyHistogram::sub_bits;
+
+    static u32 bucket_index(u64 us)
+    {
+        if (us < linear_buckets) return (u32)us;
+        if (us > UINT32_MAX) us = UINT32_MAX;
+        const u32 shift = (u32)std::bit_width(us) - 1 - LatencyHistogram::sub_bits;
+        return ((shift + 1) << LatencyHistogram::sub_bits) + (u32)((us >> shift) & (linear_buckets - 1));
+    }
+
+    static u64 bucket_upper_bound(u32 index)
+    {
+        if (index < linear_buckets) return index;
+        const u32 shift = (index >> LatencyHistogram::sub_bits) - 1;
+        const u64 lower = (linear_buckets + (index & (linear_buckets - 1))) << shift;
+        return lower + ((u64)1 << shift) - 1;
+    }
+
+    void LatencyHistogram::record(u64 us)
+    {
+        buckets[bucket_index(us)].fetch_add(1, std::memory_order_relaxed);
+        sum_us.fetch_add(us, std::memory_order_relaxed);
+        u64 prev = max_us.load(std::memory_order_relaxed);
+        while (prev < us && !max_us.compare_exchange_weak(prev, us, std::memory_order_relaxed)) {}
+    }
+
+    void LatencyHistogram::reset()
+    {
+        for (auto &bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        sum_us.store(0, std::memory_order_relaxed);
+        max_us.store(0, std::memory_order_relaxed);
+    }
+
+    LatencySummary LatencyHistogram::summarize() const
+    {
+        u64 snapshot[bucket_count];
+        u64 total = 0;
+        for (u32 i = 0; i < bucket_count; ++i) total += snapshot[i] = buckets[i].load(std::memory_order_relaxed);
+
+        LatencySummary s{};
+        s.count = total;
+        if (!total) return s;
+        s.max_us = max_us.load(std::memory_order_relaxed);
+        s.mean_us = sum_us.load(std::memory_order_relaxed) / total;
+
+        // Buckets report their upper bound, so percentiles err on the slow side
+        auto percentile = [&](u64 permille) {
+            const u64 rank = (total * permille + 999) / 1000;
+            u64 seen = 0;
+            for (u32 i = 0; i < bucket_count; ++i)
+                if ((seen += snapshot[i]) >= rank) return std::min(bucket_upper_bound(i), s.max_us);
+            return s.max_us;
+        };
+        s.p50_us = percentile(500);
+        s.p90_us = percentile(900);
+        s.p99_us = percentile(990);
+        return s;
+    }
+
+    using StatsMap = acul::hashmap<acul::string, acul::unique_ptr<EndpointStats>>;
+
+    // Maps are written on the main thread under the lock, so main-thread lookups need none
+    static std::mutex registry_lock;
+    static acul::vector<EndpointStats *> endpoints;
+    static StatsMap route_maps[4];
+    static StatsMap handler_map;
+    static StatsMap call_map;
+    static StatsMap aggregate_map;
+
+    static const char *kind_name(EndpointKind kind)
+    {
+        switch (kind)
+        {
+            case EndpointKind::route:
+                return "route";
+            case EndpointKind::static_file:
+                return "static";
+            case EndpointKind::blob:
+                return "blob";
+            case EndpointKind::not_found:
+                return "not_found";
+            case EndpointKind::batch:
+                return "batch";
+            case EndpointKind::handler:
+                return "handler";
+            default:
+                return "call";
+        }
+    }
+
+    static EndpointStats *insert_stats(StatsMap &map, const acul::string &key, EndpointKind kind, acul::string &&name)
+    {
+        std::lock_guard<std::mutex> lock(registry_lock);
+        auto *stats = acul::alloc<EndpointStats>(kind, std::move(name));
+        map.emplace(key, acul::unique_ptr<EndpointStats>(stats));
+        endpoints.push_back(stats);
+        return stats;
+    }
+
+    EndpointStats *route_stats(Method method, const acul::string &path)
+    {
+        auto &map = route_maps[(int)method];
+        if (auto it = map.find(path); it != map.end()) return it->second.get();
+        return insert_stats(map, path, EndpointKind::route, acul::format("%s %s", method_name(method), path.c_str()));
+    }
+
+    EndpointStats *handler_stats(EndpointKind kind, const char *name)
+    {
+        auto &map = kind == EndpointKind::call ? call_map : handler_map;
+        if (auto it = map.find(name); it != map.end()) return it->second.get();
+        return insert_stats(map, name, kind, acul::string(name));
+    }
+
+    EndpointStats *aggregate_stats(EndpointKind kind)
+    {
+        const char *name = kind_name(kind);
+        if (auto it = aggregate_map.find(name); it != aggregate_map.end()) return it->second.get();
+        return insert_stats(aggregate_map, name, kind, acul::string(name));
+    }
+
+    acul::vector<EndpointMetrics> collect_metrics()
+    {
+        std::lock_guard<std::mutex> lock(registry_lock);
+        acul::vector<EndpointMetrics> out;
+        out.reserve(endpoints.size());
+        for (auto *stats : endpoints)
+        {
+            EndpointMetrics m;
+            m.kind = stats->kind;
+            m.name = stats->name;
+            m.errors = stats->errors.load(std::memory_order_relaxed);
+            m.bytes = stats->bytes.load(std::memory_order_relaxed);
+            m.cache_hits = stats->cache_hits.load(std::memory_order_relaxed);
+            m.cache_misses = stats->cache_misses.load(std::memory_order_relaxed);
+            m.stalls = stats->stalls.load(std::memory_order_relaxed);
+            m.stall_ms = stats->stall_ms.load(std::memory_order_relaxed);
+            m.latency = stats->latency.summarize();
+            m.completion = stats->completion.summarize();
+            out.push_back(std::move(m));
+        }
+        return out;
+    }
+
+    static void write_summary(rapidjson::Writer<StringOutputStream> &w, const LatencySummary &s)
+    {
+        w.StartObject();
+        w.Key("count");
+        w.Uint64(s.count);
+        w.Key("mean");
+        w.Uint64(s.mean_us);
+        w.Key("p50");
+        w.Uint64(s.p50_us);
+        w.Key("p90");
+        w.Uint64(s.p90_us);
+        w.Key("p99");
+        w.Uint64(s.p99_us);
+        w.Key("max");
+        w.Uint64(s.max_us);
+        w.EndObject();
+    }
+
+    acul::string metrics_json()
+    {
+        acul::vector<EndpointMetrics> metrics = collect_metrics();
+        const StallSummary stalls = collect_stalls();
+        u64 sync = 0, async = 0;
+        for (auto &m : metrics)
+        {
+            if (m.kind == EndpointKind::handler) sync += m.latency.count;
+            else if (m.kind == EndpointKind::call) async += m.latency.count;
+        }
+
+        acul::string json;
+        StringOutputStream os{json};
+        rapidjson::Writer<StringOutputStream> w(os);
+        w.StartObject();
+        w.Key("sync");
+        w.Uint64(sync);
+        w.Key("async");
+        w.Uint64(async);
+        w.Key("stalls");
+        w.StartObject();
+        w.Key("count");
+        w.Uint64(stalls.count);
+        w.Key("unattributed");
+        w.Uint64(stalls.unattributed);
+        w.Key("total_ms");
+        w.Uint64(stalls.total_ms);
+        w.Key("max_ms");
+        w.Uint64(stalls.max_ms);
+        w.EndObject();
+        w.Key("endpoints");
+        w.StartArray();
+        for (auto &m : metrics)
+        {
+            w.StartObject();
+            w.Key("name");
+            w.String(m.name.c_str(), (rapidjson::SizeType)m.name.size());
+            w.Key("kind");
+            w.String(kind_name(m.kind));
+            w.Key("errors");
+            w.Uint64(m.errors);
+            w.Key("bytes");
+            w.Uint64(m.bytes);
+            w.Key("cache_hits");
+            w.Uint64(m.cache_hits);
+            w.Key("cache_misses");
+            w.Uint64(m.cache_misses);
+            w.Key("stalls");
+            w.Uint64(m.stalls);
+            w.Key("stall_ms");
+            w.Uint64(m.stall_ms);
+            w.Key("latency_us");
+            write_summary(w, m.latency);
+            if (m.kind == EndpointKind::call || m.completion.count)
+            {
+                w.Key("completion_us");
+                write_summary(w, m.completion);
+            }
+            w.EndObject();
+        }
+        w.EndArray();
+        w.EndObject();
+        return json;
+    }
+
+    void reset_metrics()
+    {
+        reset_stall_stats();
+        std::lock_guard<std::mutex> lock(registry_lock);
+        for (auto *stats : endpoints)
+        {
+            stats->errors.store(0, std::memory_order_relaxed);
+            stats->bytes.store(0, std::memory_order_relaxed);
+            stats->cache_hits.store(0, std::memory_order_relaxed);
+            stats->cache_misses.store(0, std::memory_order_relaxed);
+            stats->stalls.store(0, std::memory_order_relaxed);
+            stats->stall_ms.store(0, std::memory_order_relaxed);
+            stats->latency.reset();
+            stats->completion.reset();
+        }
+    }
+} // namespace alwf
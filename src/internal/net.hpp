@@ -0,0 +1,43 @@
+#pragma once
+
+// Portable layer over BSD sockets and Winsock, shared by the loopback HTTP transport and the worker pool
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace alwf
+{
+#ifdef _WIN32
+    using socket_t = SOCKET;
+    using pollfd_t = WSAPOLLFD;
+    inline void close_socket(socket_t s) { closesocket(s); }
+    inline int poll_sockets(pollfd_t *fds, size_t n, int timeout) { return WSAPoll(fds, (ULONG)n, timeout); }
+    inline bool would_block() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+    inline void set_nonblocking(socket_t s)
+    {
+        u_long on = 1;
+        ioctlsocket(s, FIONBIO, &on);
+    }
+    inline constexpr int send_flags = 0;
+#else
+    using socket_t = int;
+    using pollfd_t = pollfd;
+    inline constexpr socket_t INVALID_SOCKET = -1;
+    inline void close_socket(socket_t s) { close(s); }
+    inline int poll_sockets(pollfd_t *fds, size_t n, int timeout) { return poll(fds, (nfds_t)n, timeout); }
+    inline bool would_block() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+    inline void set_nonblocking(socket_t s) { fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK); }
+    // Writes to a peer that went away fail with EPIPE instead of raising SIGPIPE
+    inline constexpr int send_flags = MSG_NOSIGNAL;
+#endif
+} // namespace alwf
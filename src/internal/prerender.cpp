@@ -0,0 +1,174 @@
+#include <acul/log.hpp>
+#include <alwf/l10n.hpp>
+#include <chrono>
+#include "framework.hpp"
+
+namespace alwf
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Only touched from the main thread: scheme requests and idle tasks both run there
+    struct PrerenderEntry
+    {
+        IResponse *res;
+        Clock::time_point created;
+        u32 language; // the page was rendered in
+    };
+
+    static acul::hashmap<acul::string, PrerenderEntry> prerendered;
+    static acul::vector<acul::string> pending;
+    static size_t prerendered_bytes = 0;
+    static bool idle_scheduled = false;
+
+    static void drop_entry(acul::hashmap<acul::string, PrerenderEntry>::iterator it)
+    {
+        prerendered_bytes -= it->second.res->size();
+        acul::release(it->second.res);
+        prerendered.erase(it);
+    }
+
+    static bool is_html(const IResponse *res)
+    {
+        return res->content_type && strncmp(res->content_type, "text/html", 9) == 0;
+    }
+
+    static void prerender_next();
+
+    static void store_prerendered(const acul::string &path, u32 language, IResponse *res)
+    {
+        // Over budget: keep what is cached and give up on the rest of the queue
+        if (prerendered_bytes + res->size() > ctx->prerender_budget)
+        {
+            acul::release(res);
+            pending.clear();
+            return;
+        }
+
+        prerendered_bytes += res->size();
+        prerendered[path] = PrerenderEntry{res, Clock::now(), language};
+        // The page's build-time asset set (Router::assets) is read ahead, off the main thread
+        if (is_html(res)) prewarm_page_assets(path.c_str());
+    }
+
+    static void schedule_prerender()
+    {
+        if (idle_scheduled || pending.empty()) return;
+        idle_scheduled = true;
+        post_idle(prerender_next);
+    }
+
+    static void prerender_next()
+    {
+        idle_scheduled = false;
+        if (!ctx || pending.empty()) return;
+
+        acul::string path = std::move(pending[0]);
+        pending.erase(pending.begin());
+        auto it = ctx->router->get.find(path);
+        if (it == ctx->router->get.end() || prerendered.find(path) != prerendered.end())
+        {
+            schedule_prerender();
+            return;
+        }
+
+        Request req;
+        req.method = Method::get;
+        req.path = path;
+        req.request_ctx = nullptr;
+
+        ActivityScope activity(route_stats(Method::get, path));
+        const u32 language = current_language();
+        IResponse *res = nullptr;
+        try
+        {
+            res = it->second(req);
+        }
+        catch (const std::exception &e)
+        {
+            LOG_WARN("Prerender of %s failed: %s", path.c_str(), e.what());
+        }
+        catch (...)
+        {
+            LOG_WARN("Prerender of %s failed", path.c_str());
+        }
+        if (auto *suspended = dynamic_cast<PendingResponse *>(res))
+        {
+            // Coroutine routes are cached when they complete; the queue moves on meanwhile
+            suspended->on_complete = [path, language](IResponse *res, std::exception_ptr error) {
+                if (error) LOG_WARN("Prerender of %s failed", path.c_str());
+                if (!res) return;
+                if (error || !ctx || prerendered.find(path) != prerendered.end()) acul::release(res);
+                else store_prerendered(path, language, res);
+            };
+            res = nullptr;
+        }
+        if (res) store_prerendered(path, language, res);
+        schedule_prerender();
+    }
+
+    static void queue_prerender(const acul::string &path)
+    {
+        if (prerendered.find(path) != prerendered.end()) return;
+        for (auto &p : pending)
+            if (p == path) return;
+        pending.push_back(path);
+        schedule_prerender();
+    }
+
+    void prerender_route(const char *path)
+    {
+        post_to_main([path = acul::string(path)]() {
+            if (ctx) queue_prerender(path);
+        });
+    }
+
+    void invalidate_prerendered()
+    {
+        post_to_main([]() { destroy_prerender_cache(); });
+    }
+
+    IResponse *take_prerendered(const Request &req)
+    {
+        if (req.method != Method::get || !req.query.empty()) return nullptr;
+        auto it = prerendered.find(req.path);
+        if (it == prerendered.end()) return nullptr;
+
+        // Fetches asking for JSON expect the handler's JSON branch, not the page it rendered without headers
+        if (wants_json(req)) return nullptr;
+
+        IResponse *res = it->second.res;
+        // A page rendered before a language switch, or for another window's language, is not served
+        bool fresh = Clock::now() - it->second.created < std::chrono::milliseconds(ctx->prerender_ttl_ms) &&
+                     it->second.language == current_language();
+        if (!fresh)
+        {
+            drop_entry(it);
+            return nullptr;
+        }
+        prerendered_bytes -= res->size();
+        prerendered.erase(it);
+        return res;
+    }
+
+    void note_served_page(const Request &req, const IResponse *res)
+    {
+        if (!ctx->prerender_links || req.method != Method::get || !is_html(res)) return;
+        const acul::string html(res->data(), res->size());
+        for_each_html_attribute(html, "a", "href", [&](acul::string &&href) {
+            if (href.empty() || href[0] != '/' || href.find("//") == 0) return;
+            if (auto hash = href.find('#'); hash != acul::string::npos) href.erase(hash, href.size() - hash);
+            if (href == req.path || href.find('?') != acul::string::npos) return;
+            if (ctx->router->get.find(href) != ctx->router->get.end()) queue_prerender(href);
+        });
+    }
+
+    size_t prerender_cache_bytes() { return prerendered_bytes; }
+
+    void destroy_prerender_cache()
+    {
+        for (auto &[path, entry] : prerendered) acul::release(entry.res);
+        prerendered.clear();
+        pending.clear();
+        prerendered_bytes = 0;
+    }
+} // namespace alwf
@@ -0,0 +1,148 @@
+#include <chrono>
+#include "framework.hpp"
+
+namespace alwf
+{
+    static std::mutex channels_lock;
+    static acul::hashmap<WindowId, PushChannel *> channels;
+
+    PushChannel *open_push_channel(WindowId window)
+    {
+        PushChannel *channel = acul::alloc<PushChannel>();
+        channel->window = window;
+        channel->refs.fetch_add(1, std::memory_order_relaxed); // held by `channels`
+
+        PushChannel *prev = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(channels_lock);
+            auto &slot = channels[window];
+            prev = slot;
+            slot = channel;
+        }
+        if (prev)
+        {
+            close_push_channel(prev);
+            unref_push_channel(prev);
+        }
+        return channel;
+    }
+
+    void close_push_channel(PushChannel *channel)
+    {
+        {
+            std::lock_guard<std::mutex> lock(channel->lock);
+            channel->closed = true;
+        }
+        channel->cv.notify_all();
+
+        std::lock_guard<std::mutex> lock(channels_lock);
+        auto it = channels.find(channel->window);
+        if (it == channels.end() || it->second != channel) return;
+        channels.erase(it);
+        unref_push_channel(channel);
+    }
+
+    bool has_push_channel(WindowId window)
+    {
+        std::lock_guard<std::mutex> lock(channels_lock);
+        return channels.find(window) != channels.end();
+    }
+
+    void unref_push_channel(PushChannel *channel)
+    {
+        if (channel->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) acul::release(channel);
+    }
+
+    long read_push_channel(PushChannel *channel, char *dst, size_t len, u32 timeout_ms)
+    {
+        std::unique_lock<std::mutex> lock(channel->lock);
+        auto ready = [channel] { return channel->closed || channel->offset < channel->buffer.size(); };
+        if (!channel->cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready)) return -1;
+
+        size_t available = channel->buffer.size() - channel->offset;
+        if (available == 0) return 0; // closed and drained
+        size_t n = available < len ? available : len;
+        memcpy(dst, channel->buffer.data() + channel->offset, n);
+        channel->offset += n;
+        if (channel->offset == channel->buffer.size())
+        {
+            channel->buffer.clear();
+            channel->offset = 0;
+        }
+        return (long)n;
+    }
+
+    static bool append_frame(PushChannel *channel, const char *data, size_t len)
+    {
+        {
+            std::lock_guard<std::mutex> lock(channel->lock);
+            if (channel->closed) return false;
+            channel->buffer.append(data, data + len);
+            channel->buffer.push_back('\n');
+        }
+        channel->cv.notify_one();
+        return true;
+    }
+
+    // Returns the number of channels written
+    static size_t write_push_channels(WindowId window, const char *data, size_t len)
+    {
+        std::lock_guard<std::mutex> lock(channels_lock);
+        if (window != all_windows)
+        {
+            auto it = channels.find(window);
+            return it != channels.end() && append_frame(it->second, data, len) ? 1 : 0;
+        }
+        size_t written = 0;
+        for (auto &[id, channel] : channels) written += append_frame(channel, data, len);
+        return written;
+    }
+
+    bool push_raw_to_frontend(acul::string &&json, WindowId window)
+    {
+        const size_t written = write_push_channels(window, json.c_str(), json.size());
+        if (written) capture_message(CaptureKind::outbound, json.c_str(), json.size());
+        if (written >= (window == all_windows ? window_count() : 1)) return true;
+
+        // Windows whose page has no stream open get the message through the web view
+        if (!written) post_to_main([json = std::move(json), window]() { send_raw_to_frontend(json, window); });
+        else
+            post_to_main([json = std::move(json)]() {
+                for (WindowId id : window_ids())
+                    if (!has_push_channel(id)) send_raw_to_frontend(json, id);
+            });
+        return false;
+    }
+
+    bool push_to_frontend(const rapidjson::Value &json) { return push_to_window(all_windows, json); }
+
+    bool push_to_window(WindowId id, const rapidjson::Value &json)
+    {
+        rapidjson::StringBuffer buf;
+        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+        json.Accept(w);
+        return push_raw_to_frontend(acul::string(buf.GetString(), buf.GetSize()), id);
+    }
+
+    size_t push_pending_bytes()
+    {
+        std::lock_guard<std::mutex> lock(channels_lock);
+        size_t total = 0;
+        for (auto &[id, channel] : channels)
+        {
+            std::lock_guard<std::mutex> channel_lock(channel->lock);
+            total += channel->buffer.size() - channel->offset;
+        }
+        return total;
+    }
+
+    void destroy_push_channel()
+    {
+        acul::vector<PushChannel *> open;
+        {
+            std::lock_guard<std::mutex> lock(channels_lock);
+            for (auto &[id, channel] : channels) open.push_back(channel);
+        }
+        for (PushChannel *channel : open) close_push_channel(channel);
+    }
+} // namespace alwf
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <alwf/l10n.hpp>
+#include <chrono>
+#include "framework.hpp"
+
+namespace alwf
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Only touched from the main thread, where routes run and coroutine routes complete
+    struct RouteCacheEntry
+    {
+        IResponse *res;
+        Clock::time_point expires;
+    };
+
+    // A suspended coroutine route whose result identical requests wait for
+    struct RouteFlight
+    {
+        acul::string path;
+        acul::string variant;
+        acul::vector<PendingResponse *> followers;
+        bool stale = false; // invalidated while in flight: shared, but not cached
+    };
+
+    static acul::hashmap<acul::string, acul::hashmap<acul::string, RouteCacheEntry>> cached; // path, variant
+    static acul::hashmap<PendingResponse *, RouteFlight> flights;                           // by the leading request
+    static acul::hashmap<acul::string, PendingResponse *> joinable;                         // path?variant
+    static size_t cached_bytes = 0;
+
+    static const RouteCachePolicy *policy_for(const acul::string &path)
+    {
+        if (ctx->router->cache.empty()) return nullptr;
+        auto it = ctx->router->cache.find(path);
+        return it == ctx->router->cache.end() ? nullptr : &it->second;
+    }
+
+    // Parameter order does not change the result. A request that wants_json() may get the handler's JSON branch, so it
+    // gets its own entry. With a string table, each language renders its own entry.
+    static acul::string variant_of(const Request &req)
+    {
+        acul::vector<acul::string> params;
+        for (size_t start = 0; start < req.query.size();)
+        {
+            size_t amp = req.query.find('&', start);
+            if (amp == acul::string::npos) amp = req.query.size();
+            if (amp > start) params.push_back(req.query.substr(start, amp - start));
+            start = amp + 1;
+        }
+        std::sort(params.begin(), params.end(),
+                  [](const acul::string &a, const acul::string &b) { return strcmp(a.c_str(), b.c_str()) < 0; });
+
+        acul::string variant;
+        for (auto &param : params)
+        {
+            if (!variant.empty()) variant.push_back('&');
+            variant.append(param);
+        }
+        if (wants_json(req)) variant.append("#json");
+        if (ctx->strings) variant.append(acul::format("@%u", current_language()));
+        return variant;
+    }
+
+    // Every consumer gets its own copy: the backends take ownership, and fragment extraction replaces it
+    static IResponse *copy_response(const IResponse *res)
+    {
+        acul::vector<char> data(res->data(), res->data() + res->size());
+        return acul::alloc<BinaryResponse>(std::move(data), res->content_type);
+    }
+
+    static void drop_entry(acul::hashmap<acul::string, RouteCacheEntry> &entries,
+                           acul::hashmap<acul::string, RouteCacheEntry>::iterator it)
+    {
+        cached_bytes -= it->second.res->size();
+        acul::release(it->second.res);
+        entries.erase(it);
+    }
+
+    static void cache_result(const acul::string &path, const acul::string &variant, const IResponse *res)
+    {
+        const RouteCachePolicy *policy = policy_for(path);
+        if (!policy || policy->ttl_ms == 0) return;
+
+        auto &entries = cached[path];
+        if (auto it = entries.find(variant); it != entries.end()) drop_entry(entries, it);
+        if (!entries.empty() && entries.size() >= std::max(policy->max_entries, 1u))
+        {
+            // All entries of a route share its TTL, so the first to expire is the oldest
+            auto oldest = std::min_element(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+                return a.second.expires < b.second.expires;
+            });
+            drop_entry(entries, oldest);
+        }
+        entries.emplace(variant,
+                        RouteCacheEntry{copy_response(res), Clock::now() + std::chrono::milliseconds(policy->ttl_ms)});
+        cached_bytes += res->size();
+    }
+
+    IResponse *lookup_route_cache(const Request &req)
+    {
+        if (req.method != Method::get || !policy_for(req.path)) return nullptr;
+        const acul::string variant = variant_of(req);
+
+        if (auto route = cached.find(req.path); route != cached.end())
+        {
+            if (auto it = route->second.find(variant); it != route->second.end())
+            {
+                if (Clock::now() < it->second.expires) return copy_response(it->second.res);
+                drop_entry(route->second, it);
+            }
+        }
+
+        auto flight = joinable.find(acul::format("%s?%s", req.path.c_str(), variant.c_str()));
+        if (flight == joinable.end()) return nullptr;
+        auto *follower = acul::alloc<PendingResponse>();
+        flights[flight->second].followers.push_back(follower);
+        return follower;
+    }
+
+    void store_route_result(const Request &req, IResponse *res)
+    {
+        if (!res || req.method != Method::get || !policy_for(req.path)) return;
+        acul::string variant = variant_of(req);
+        if (auto *leader = dynamic_cast<PendingResponse *>(res))
+        {
+            joinable[acul::format("%s?%s", req.path.c_str(), variant.c_str())] = leader;
+            flights[leader] = RouteFlight{req.path, std::move(variant), {}};
+        }
+        else cache_result(req.path, variant, res);
+    }
+
+    void settle_route_flight(PendingResponse *leader, const IResponse *res, std::exception_ptr error)
+    {
+        auto it = flights.find(leader);
+        if (it == flights.end()) return;
+        RouteFlight flight = std::move(it->second);
+        flights.erase(it);
+        auto key = joinable.find(acul::format("%s?%s", flight.path.c_str(), flight.variant.c_str()));
+        if (key != joinable.end() && key->second == leader) joinable.erase(key);
+
+        if (error) res = nullptr;
+        if (res && !flight.stale) cache_result(flight.path, flight.variant, res);
+        for (auto *follower : flight.followers)
+        {
+            IResponse *copy = res ? copy_response(res) : nullptr;
+            if (follower->on_complete) follower->on_complete(copy, error);
+            else if (copy) acul::release(copy);
+            acul::release(follower);
+        }
+    }
+
+    void invalidate_route_cache(const char *path)
+    {
+        for (auto &[leader, flight] : flights)
+        {
+            if (path && flight.path != path) continue;
+            flight.stale = true;
+            auto key = joinable.find(acul::format("%s?%s", flight.path.c_str(), flight.variant.c_str()));
+            if (key != joinable.end() && key->second == leader) joinable.erase(key);
+        }
+        if (!path)
+        {
+            destroy_route_cache();
+            return;
+        }
+        auto route = cached.find(path);
+        if (route == cached.end()) return;
+        for (auto &[variant, entry] : route->second)
+        {
+            cached_bytes -= entry.res->size();
+            acul::release(entry.res);
+        }
+        cached.erase(route);
+    }
+
+    size_t route_cache_bytes() { return cached_bytes; }
+
+    void destroy_route_cache()
+    {
+        for (auto &[path, entries] : cached)
+            for (auto &[variant, entry] : entries) acul::release(entry.res);
+        cached.clear();
+        cached_bytes = 0;
+    }
+} // namespace alwf
@@ -0,0 +1,207 @@
+#include <acul/log.hpp>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include "framework.hpp"
+
+namespace alwf
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingCall
+    {
+        acul::string js_id;
+        Clock::time_point deadline;
+        Clock::time_point started;
+        EndpointStats *stats;
+        WindowId window; // the caller, which gets the reply
+    };
+
+    static std::mutex pending_lock;
+    static acul::hashmap<u64, PendingCall> pending;
+    static u64 next_call_id = 1;
+
+    static acul::string make_reply(const acul::string &js_id, bool ok, const char *data, size_t len)
+    {
+        rapidjson::StringBuffer buf;
+        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+        w.StartObject();
+        w.Key("handler");
+        w.String("__alwf_reply");
+        w.Key("__call");
+        w.String(js_id.c_str(), (rapidjson::SizeType)js_id.size());
+        w.Key("ok");
+        w.Bool(ok);
+        if (ok)
+        {
+            w.Key("result");
+            w.RawValue(data, len, rapidjson::kObjectType);
+        }
+        else
+        {
+            w.Key("error");
+            w.String(data, (rapidjson::SizeType)len);
+        }
+        w.EndObject();
+        return acul::string(buf.GetString(), buf.GetSize());
+    }
+
+    static bool take_pending(u64 id, PendingCall &call)
+    {
+        std::lock_guard<std::mutex> lock(pending_lock);
+        auto it = pending.find(id);
+        if (it == pending.end()) return false;
+        call = std::move(it->second);
+        pending.erase(it);
+        return true;
+    }
+
+    static void record_completion(const PendingCall &call, bool ok, size_t reply_size)
+    {
+        call.stats->completion.record(elapsed_us(call.started));
+        call.stats->bytes.fetch_add(reply_size, std::memory_order_relaxed);
+        if (!ok) call.stats->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static bool complete(u64 id, bool ok, const char *data, size_t len)
+    {
+        PendingCall call;
+        if (!take_pending(id, call)) return false;
+        acul::string reply = make_reply(call.js_id, ok, data, len);
+        record_completion(call, ok, reply.size());
+        post_to_main([reply = std::move(reply), window = call.window]() { send_raw_to_frontend(reply, window); });
+        return true;
+    }
+
+    // Deadline of the armed expiry timer; main thread only. Every call gets the same timeout, so deadlines arrive in
+    // order and one timer is armed at a time.
+    static Clock::time_point next_expiry = Clock::time_point::max();
+
+    static void schedule_expiry(Clock::time_point deadline);
+
+    static void expire_calls()
+    {
+        next_expiry = Clock::time_point::max();
+        const auto now = Clock::now();
+        acul::vector<PendingCall> expired;
+        auto earliest = Clock::time_point::max();
+        {
+            std::lock_guard<std::mutex> lock(pending_lock);
+            for (auto it = pending.begin(); it != pending.end();)
+            {
+                if (it->second.deadline > now)
+                {
+                    earliest = std::min(earliest, it->second.deadline);
+                    ++it;
+                    continue;
+                }
+                expired.push_back(std::move(it->second));
+                it = pending.erase(it);
+            }
+        }
+        static const char timeout_msg[] = "Call timed out";
+        for (auto &call : expired)
+        {
+            acul::string reply = make_reply(call.js_id, false, timeout_msg, sizeof(timeout_msg) - 1);
+            record_completion(call, false, reply.size());
+            send_raw_to_frontend(reply, call.window);
+        }
+        if (earliest != Clock::time_point::max()) schedule_expiry(earliest);
+    }
+
+    static void schedule_expiry(Clock::time_point deadline)
+    {
+        if (deadline >= next_expiry) return;
+        next_expiry = deadline;
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        post_delayed(ms > 0 ? (u32)ms : 0, [] { expire_calls(); });
+    }
+
+    void drop_window_calls(WindowId window)
+    {
+        // The page that made these calls is gone; its replacement reuses the same call ids
+        std::lock_guard<std::mutex> lock(pending_lock);
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (it->second.window == window) it = pending.erase(it);
+            else ++it;
+        }
+    }
+
+    void begin_call(const char *handler, const rapidjson::Document &doc)
+    {
+        assert(ctx && "Context is not initialized");
+        const auto now = Clock::now();
+
+        acul::string js_id = doc["__call"].GetString();
+        CallHandler *fn = nullptr;
+        if (ctx->call_router)
+            if (auto it = ctx->call_router->find(handler); it != ctx->call_router->end()) fn = &it->second;
+        if (!fn)
+        {
+            static const char missing_msg[] = "No such handler";
+            LOG_ERROR("No such call handler: %s", handler);
+            send_raw_to_frontend(make_reply(js_id, false, missing_msg, sizeof(missing_msg) - 1), current_window());
+            return;
+        }
+
+        EndpointStats *stats = handler_stats(EndpointKind::call, handler);
+        Call call;
+        const auto deadline =
+            ctx->call_timeout_ms ? now + std::chrono::milliseconds(ctx->call_timeout_ms) : Clock::time_point::max();
+        {
+            std::lock_guard<std::mutex> lock(pending_lock);
+            call.id = next_call_id++;
+            pending.emplace(call.id, PendingCall{std::move(js_id), deadline, now, stats, current_window()});
+        }
+        if (ctx->call_timeout_ms) schedule_expiry(deadline);
+
+        ActivityScope activity(stats);
+        try
+        {
+            (*fn)(doc, call);
+        }
+        catch (const std::exception &e)
+        {
+            reject_call(call.id, e.what());
+        }
+        catch (...)
+        {
+            reject_call(call.id, "Unknown error");
+        }
+        stats->latency.record(elapsed_us(now));
+    }
+
+    void cancel_call(const char *js_id)
+    {
+        // Call ids are only unique within a page
+        const WindowId window = current_window();
+        std::lock_guard<std::mutex> lock(pending_lock);
+        for (auto it = pending.begin(); it != pending.end(); ++it)
+        {
+            if (it->second.js_id != js_id || it->second.window != window) continue;
+            pending.erase(it);
+            return;
+        }
+    }
+
+    bool resolve_call(u64 id, const rapidjson::Value &result)
+    {
+        rapidjson::StringBuffer buf;
+        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+        result.Accept(w);
+        return complete(id, true, buf.GetString(), buf.GetSize());
+    }
+
+    bool reject_call(u64 id, const char *error) { return complete(id, false, error, strlen(error)); }
+
+    bool Call::resolve(const rapidjson::Value &result) const { return resolve_call(id, result); }
+
+    bool Call::reject(const char *error) const { return reject_call(id, error); }
+
+    bool Call::cancelled() const
+    {
+        std::lock_guard<std::mutex> lock(pending_lock);
+        return pending.find(id) == pending.end();
+    }
+} // namespace alwf
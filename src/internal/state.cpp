@@ -0,0 +1,215 @@
+#include <alwf/state.hpp>
+#include <rapidjson/pointer.h>
+#include "framework.hpp"
+
+namespace alwf
+{
+    static std::mutex stores_lock;
+    static acul::hashmap<acul::string, StateStore *> stores;
+
+    // Old values are not reclaimed by rapidjson's pool allocator, so the tree is copied into a fresh document
+    // every so often to bound memory growth
+    static constexpr u64 compact_interval = 256;
+
+    static void append_token(acul::string &path, const char *key, size_t len)
+    {
+        path.push_back('/');
+        for (size_t i = 0; i < len; ++i)
+        {
+            if (key[i] == '~') path.append("~0");
+            else if (key[i] == '/') path.append("~1");
+            else path.push_back(key[i]);
+        }
+    }
+
+    StateStore::StateStore(const char *name) : _name(name)
+    {
+        _doc.SetObject();
+        _ops.SetArray();
+        std::lock_guard<std::mutex> lock(stores_lock);
+        stores[_name] = this;
+    }
+
+    StateStore::~StateStore()
+    {
+        std::lock_guard<std::mutex> lock(stores_lock);
+        if (auto it = stores.find(_name); it != stores.end() && it->second == this) stores.erase(it);
+    }
+
+    void StateStore::add_op(const char *op, const acul::string &path, const rapidjson::Value *value)
+    {
+        auto &a = _ops.GetAllocator();
+        rapidjson::Value entry(rapidjson::kObjectType);
+        entry.AddMember("op", rapidjson::StringRef(op), a);
+        entry.AddMember("path", rapidjson::Value(path.c_str(), (rapidjson::SizeType)path.size(), a), a);
+        if (value) entry.AddMember("value", rapidjson::Value(*value, a), a);
+        _ops.PushBack(entry, a);
+    }
+
+    void StateStore::diff(const acul::string &path, const rapidjson::Value &from, const rapidjson::Value &to)
+    {
+        if (from.IsObject() && to.IsObject())
+        {
+            for (auto m = from.MemberBegin(); m != from.MemberEnd(); ++m)
+            {
+                if (to.FindMember(m->name) != to.MemberEnd()) continue;
+                acul::string child = path;
+                append_token(child, m->name.GetString(), m->name.GetStringLength());
+                add_op("remove", child, nullptr);
+            }
+            for (auto m = to.MemberBegin(); m != to.MemberEnd(); ++m)
+            {
+                acul::string child = path;
+                append_token(child, m->name.GetString(), m->name.GetStringLength());
+                auto prev = from.FindMember(m->name);
+                if (prev == from.MemberEnd()) add_op("add", child, &m->value);
+                else diff(child, prev->value, m->value);
+            }
+            return;
+        }
+
+        if (from.IsArray() && to.IsArray() && from.Size() == to.Size())
+        {
+            for (rapidjson::SizeType i = 0; i < to.Size(); ++i)
+                diff(acul::format("%s/%u", path.c_str(), i), from[i], to[i]);
+            return;
+        }
+
+        if (from != to) add_op("replace", path, &to);
+    }
+
+    bool StateStore::set(const char *path, const rapidjson::Value &value)
+    {
+        rapidjson::Pointer ptr(path);
+        if (!ptr.IsValid()) return false;
+
+        std::lock_guard<std::mutex> lock(_lock);
+        if (const rapidjson::Value *current = ptr.Get(_doc)) diff(path, *current, value);
+        else add_op("add", path, &value);
+        ptr.Set(_doc, value);
+        schedule_flush();
+        return true;
+    }
+
+    bool StateStore::remove(const char *path)
+    {
+        rapidjson::Pointer ptr(path);
+        if (!ptr.IsValid() || ptr.GetTokenCount() == 0) return false;
+
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!ptr.Erase(_doc)) return false;
+        add_op("remove", path, nullptr);
+        schedule_flush();
+        return true;
+    }
+
+    bool StateStore::get(const char *path, rapidjson::Document &out) const
+    {
+        rapidjson::Pointer ptr(path);
+        if (!ptr.IsValid()) return false;
+
+        std::lock_guard<std::mutex> lock(_lock);
+        const rapidjson::Value *value = ptr.Get(_doc);
+        if (!value) return false;
+        out.CopyFrom(*value, out.GetAllocator());
+        return true;
+    }
+
+    u64 StateStore::version() const
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _version;
+    }
+
+    void StateStore::schedule_flush()
+    {
+        if (_flush_pending) return;
+        _flush_pending = true;
+        post_to_main([name = _name]() {
+            std::lock_guard<std::mutex> lock(stores_lock);
+            if (auto it = stores.find(name); it != stores.end()) it->second->flush();
+        });
+    }
+
+    static void write_header(rapidjson::Writer<rapidjson::StringBuffer> &w, const acul::string &name, u64 version)
+    {
+        w.StartObject();
+        w.Key("handler");
+        w.String("__alwf_state");
+        w.Key("store");
+        w.String(name.c_str(), (rapidjson::SizeType)name.size());
+        w.Key("version");
+        w.Uint64(version);
+    }
+
+    // Moves the pending operations into a versioned frame; _lock must be held
+    bool StateStore::write_ops(rapidjson::StringBuffer &buf)
+    {
+        if (_ops.Empty()) return false;
+
+        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+        write_header(w, _name, ++_version);
+        w.Key("ops");
+        _ops.Accept(w);
+        w.EndObject();
+
+        rapidjson::Document ops;
+        ops.SetArray();
+        _ops.Swap(ops);
+
+        if (_version % compact_interval == 0)
+        {
+            rapidjson::Document fresh;
+            fresh.CopyFrom(_doc, fresh.GetAllocator());
+            _doc.Swap(fresh);
+        }
+        return true;
+    }
+
+    void StateStore::flush()
+    {
+        rapidjson::StringBuffer buf;
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            _flush_pending = false;
+            if (!write_ops(buf)) return;
+        }
+        push_raw_to_frontend(acul::string(buf.GetString(), buf.GetSize()));
+    }
+
+    void StateStore::sync(WindowId window)
+    {
+        rapidjson::StringBuffer ops;
+        rapidjson::StringBuffer buf;
+        bool has_ops = false;
+        {
+            std::lock_guard<std::mutex> lock(_lock);
+            if (!_ops.Empty())
+            {
+                // A snapshot for one window carries the pending operations, but the other windows still need them
+                if (window != all_windows) has_ops = write_ops(ops);
+                else
+                {
+                    ++_version;
+                    rapidjson::Document pending;
+                    pending.SetArray();
+                    _ops.Swap(pending);
+                }
+            }
+
+            rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+            write_header(w, _name, _version);
+            w.Key("snapshot");
+            _doc.Accept(w);
+            w.EndObject();
+        }
+        if (has_ops) push_raw_to_frontend(acul::string(ops.GetString(), ops.GetSize()));
+        push_raw_to_frontend(acul::string(buf.GetString(), buf.GetSize()), window);
+    }
+
+    void sync_state_store(const char *name, WindowId window)
+    {
+        std::lock_guard<std::mutex> lock(stores_lock);
+        if (auto it = stores.find(name); it != stores.end()) it->second->sync(window);
+    }
+} // namespace alwf
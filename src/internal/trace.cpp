@@ -0,0 +1,133 @@
+#include <acul/log.hpp>
+#include <cstdio>
+#include <mutex>
+#include "framework.hpp"
+
+namespace alwf
+{
+    // Captured during static initialization, which is as close to process start as portable code gets
+    static const MetricsClock::time_point process_start = MetricsClock::now();
+
+    struct TraceEvent
+    {
+        acul::string name;
+        char phase; // 'X' complete, 'i' instant
+        i64 ts_us;
+        i64 dur_us;
+        u32 tid;
+        acul::string args; // raw JSON object or empty
+    };
+
+    static std::atomic<bool> tracing{false};
+    static std::mutex trace_lock;
+    static acul::vector<TraceEvent> events;
+    static acul::string trace_path;
+    static std::atomic<u32> next_tid{1};
+
+    static i64 since_start_us(MetricsClock::time_point t)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(t - process_start).count();
+    }
+
+    static u32 current_tid()
+    {
+        thread_local u32 tid = next_tid.fetch_add(1, std::memory_order_relaxed);
+        return tid;
+    }
+
+    static void add_event(TraceEvent &&event)
+    {
+        std::lock_guard<std::mutex> lock(trace_lock);
+        if (tracing.load(std::memory_order_relaxed)) events.push_back(std::move(event));
+    }
+
+    void start_startup_trace(const char *path)
+    {
+        std::lock_guard<std::mutex> lock(trace_lock);
+        trace_path = path;
+        events.clear();
+        tracing.store(true, std::memory_order_relaxed);
+    }
+
+    bool startup_tracing() { return tracing.load(std::memory_order_relaxed); }
+
+    void trace_span(acul::string &&name, MetricsClock::time_point start)
+    {
+        if (!startup_tracing()) return;
+        const auto now = MetricsClock::now();
+        add_event({std::move(name), 'X', since_start_us(start), since_start_us(now) - since_start_us(start),
+                   current_tid(), {}});
+    }
+
+    void trace_instant(acul::string &&name, acul::string &&args)
+    {
+        if (!startup_tracing()) return;
+        add_event({std::move(name), 'i', since_start_us(MetricsClock::now()), 0, current_tid(), std::move(args)});
+    }
+
+    void finish_startup_trace()
+    {
+        acul::vector<TraceEvent> done;
+        acul::string path;
+        {
+            std::lock_guard<std::mutex> lock(trace_lock);
+            if (!tracing.load(std::memory_order_relaxed)) return;
+            tracing.store(false, std::memory_order_relaxed);
+            done.swap(events);
+            path = std::move(trace_path);
+        }
+
+        acul::string json;
+        StringOutputStream os{json};
+        rapidjson::Writer<StringOutputStream> w(os);
+        w.StartObject();
+        w.Key("displayTimeUnit");
+        w.String("ms");
+        w.Key("traceEvents");
+        w.StartArray();
+        for (auto &e : done)
+        {
+            w.StartObject();
+            w.Key("name");
+            w.String(e.name.c_str(), (rapidjson::SizeType)e.name.size());
+            w.Key("cat");
+            w.String("startup");
+            w.Key("ph");
+            w.String(&e.phase, 1);
+            w.Key("ts");
+            w.Int64(e.ts_us);
+            if (e.phase == 'X')
+            {
+                w.Key("dur");
+                w.Int64(e.dur_us);
+            }
+            else
+            {
+                w.Key("s");
+                w.String("g");
+            }
+            w.Key("pid");
+            w.Int(1);
+            w.Key("tid");
+            w.Uint(e.tid);
+            if (!e.args.empty())
+            {
+                w.Key("args");
+                w.RawValue(e.args.c_str(), e.args.size(), rapidjson::kObjectType);
+            }
+            w.EndObject();
+        }
+        w.EndArray();
+        w.EndObject();
+
+        FILE *f = fopen(path.c_str(), "wb");
+        if (!f)
+        {
+            LOG_ERROR("Failed to write startup trace: %s", path.c_str());
+            return;
+        }
+        fwrite(json.data(), 1, json.size(), f);
+        fclose(f);
+        LOG_INFO("Startup trace written to %s", path.c_str());
+    }
+} // namespace alwf
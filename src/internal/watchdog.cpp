@@ -0,0 +1,151 @@
+#include <acul/log.hpp>
+#include <thread>
+#include "framework.hpp"
+
+namespace alwf
+{
+    static std::atomic<bool> tracking{false};
+    static std::atomic<EndpointStats *> active_endpoint{nullptr};
+    static std::atomic<i64> active_since_us{0};
+
+    static std::atomic<u64> stall_count{0};
+    static std::atomic<u64> unattributed_stalls{0};
+    static std::atomic<u64> stall_total_ms{0};
+    static std::atomic<u64> stall_max_ms{0};
+
+    // Set when a heartbeat is posted and cleared by the main loop once it runs
+    static std::atomic<bool> heartbeat_pending{false};
+    static std::atomic<i64> heartbeat_us{0};
+
+    static struct Watchdog
+    {
+        std::thread thread;
+        std::mutex lock;
+        std::condition_variable cv;
+        bool stop = false;
+        u32 threshold_ms;
+        bool sample_stack;
+    } *watchdog = nullptr;
+
+    static i64 now_us()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(MetricsClock::now().time_since_epoch()).count();
+    }
+
+    EndpointStats *swap_activity(EndpointStats *stats)
+    {
+        if (!tracking.load(std::memory_order_relaxed)) return nullptr;
+        if (stats) active_since_us.store(now_us(), std::memory_order_relaxed);
+        return active_endpoint.exchange(stats, std::memory_order_release);
+    }
+
+    static EndpointStats *report_stall(i64 stalled_us)
+    {
+        stall_count.fetch_add(1, std::memory_order_relaxed);
+        EndpointStats *culprit = active_endpoint.load(std::memory_order_acquire);
+        if (culprit)
+        {
+            culprit->stalls.fetch_add(1, std::memory_order_relaxed);
+            const i64 running_us = now_us() - active_since_us.load(std::memory_order_relaxed);
+            LOG_WARN("Main loop stalled for %lld ms in %s, running for %lld ms", (long long)(stalled_us / 1000),
+                     culprit->name.c_str(), (long long)(running_us / 1000));
+        }
+        else
+        {
+            unattributed_stalls.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN("Main loop stalled for %lld ms outside route and handler dispatch", (long long)(stalled_us / 1000));
+        }
+
+        acul::string stack;
+        if (watchdog->sample_stack && sample_main_stack(stack)) LOG_WARN("Main thread stack:\n%s", stack.c_str());
+        return culprit;
+    }
+
+    static void finish_stall(EndpointStats *culprit, i64 stalled_us)
+    {
+        const u64 ms = (u64)(stalled_us / 1000);
+        stall_total_ms.fetch_add(ms, std::memory_order_relaxed);
+        u64 prev = stall_max_ms.load(std::memory_order_relaxed);
+        while (prev < ms && !stall_max_ms.compare_exchange_weak(prev, ms, std::memory_order_relaxed)) {}
+        if (culprit) culprit->stall_ms.fetch_add(ms, std::memory_order_relaxed);
+        LOG_INFO("Main loop resumed after %llu ms", (unsigned long long)ms);
+    }
+
+    // One heartbeat is in flight at a time; a stall is reported once per heartbeat that stays unanswered
+    // past the threshold, and its duration is recorded when the heartbeat finally runs
+    static void watch()
+    {
+        const i64 threshold_us = (i64)watchdog->threshold_ms * 1000;
+        const auto tick = std::chrono::milliseconds(std::max<u32>(watchdog->threshold_ms / 4, 10));
+        i64 sent_us = 0;
+        bool stalled = false;
+        EndpointStats *culprit = nullptr;
+
+        std::unique_lock<std::mutex> lock(watchdog->lock);
+        while (!watchdog->cv.wait_for(lock, tick, [] { return watchdog->stop; }))
+        {
+            if (!heartbeat_pending.load(std::memory_order_acquire))
+            {
+                if (stalled) finish_stall(culprit, heartbeat_us.load(std::memory_order_relaxed) - sent_us);
+                stalled = false;
+                sent_us = now_us();
+                heartbeat_pending.store(true, std::memory_order_relaxed);
+                post_to_main([] {
+                    heartbeat_us.store(now_us(), std::memory_order_relaxed);
+                    heartbeat_pending.store(false, std::memory_order_release);
+                });
+                continue;
+            }
+
+            const i64 waited_us = now_us() - sent_us;
+            if (stalled || waited_us < threshold_us) continue;
+            stalled = true;
+            culprit = report_stall(waited_us);
+        }
+    }
+
+    void start_watchdog(u32 threshold_ms, bool sample_stack)
+    {
+        if (watchdog || !threshold_ms) return;
+        if (sample_stack) init_stack_sampler();
+        watchdog = acul::alloc<Watchdog>();
+        watchdog->threshold_ms = threshold_ms;
+        watchdog->sample_stack = sample_stack;
+        heartbeat_pending.store(false, std::memory_order_relaxed);
+        tracking.store(true, std::memory_order_relaxed);
+        watchdog->thread = std::thread(watch);
+    }
+
+    void stop_watchdog()
+    {
+        if (!watchdog) return;
+        {
+            std::lock_guard<std::mutex> lock(watchdog->lock);
+            watchdog->stop = true;
+        }
+        watchdog->cv.notify_all();
+        watchdog->thread.join();
+        tracking.store(false, std::memory_order_relaxed);
+        active_endpoint.store(nullptr, std::memory_order_relaxed);
+        acul::release(watchdog);
+        watchdog = nullptr;
+    }
+
+    StallSummary collect_stalls()
+    {
+        StallSummary s;
+        s.count = stall_count.load(std::memory_order_relaxed);
+        s.unattributed = unattributed_stalls.load(std::memory_order_relaxed);
+        s.total_ms = stall_total_ms.load(std::memory_order_relaxed);
+        s.max_ms = stall_max_ms.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void reset_stall_stats()
+    {
+        stall_count.store(0, std::memory_order_relaxed);
+        unattributed_stalls.store(0, std::memory_order_relaxed);
+        stall_total_ms.store(0, std::memory_order_relaxed);
+        stall_max_ms.store(0, std::memory_order_relaxed);
+    }
+} // namespace alwf
@@ -4,6 +4,8 @@
 #include <rapidjson/document.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <mutex>
+#include <thread>
 #include <shlwapi.h>
 #include "../framework.hpp"
 #include "init.hpp"
@@ -20,21 +22,13 @@ namespace alwf
     HRESULT STDMETHODCALLTYPE WebMessageHandler::Invoke(ICoreWebView2 *sender,
                                                         ICoreWebView2WebMessageReceivedEventArgs *args)
     {
-        assert(ctx && ctx->handler_router);
         LPWSTR message = nullptr;
         args->get_WebMessageAsJson(&message);
         if (message)
         {
             auto u8message = acul::utf16_to_utf8(reinterpret_cast<const std::u16string::value_type *>(message));
-            rapidjson::Document doc;
-            doc.Parse(u8message.c_str());
-            if (!doc.HasParseError() && doc.HasMember("handler"))
-            {
-                acul::string handler = doc["handler"].GetString();
-                auto it = ctx->handler_router->find(handler);
-                if (it != ctx->handler_router->end()) it->second(doc);
-                else LOG_ERROR("No such handler: %s", handler.c_str());
-            }
+            WindowScope scope(_window);
+            dispatch_message(u8message.c_str());
         }
         CoTaskMemFree(message);
         return S_OK;
@@ -53,6 +47,61 @@ namespace alwf
         return E_NOINTERFACE;
     }
 
+    // ----------------------------------------------------
+    // PushStream
+    // ----------------------------------------------------
+    // WebView2 reads response streams on a background thread, so Read() may block until a frame arrives
+    HRESULT STDMETHODCALLTYPE PushStream::Read(void *pv, ULONG cb, ULONG *pcbRead)
+    {
+        long n = -1;
+        while (n < 0) n = read_push_channel(_channel, static_cast<char *>(pv), cb, 250);
+        _position += n;
+        if (pcbRead) *pcbRead = (ULONG)n;
+        return n > 0 ? S_OK : S_FALSE;
+    }
+
+    HRESULT STDMETHODCALLTYPE PushStream::Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER *plibNewPosition)
+    {
+        // Only position queries are supported: the stream is forward-only
+        if (dlibMove.QuadPart != 0 || dwOrigin == STREAM_SEEK_END) return STG_E_INVALIDFUNCTION;
+        if (dwOrigin == STREAM_SEEK_SET && _position != 0) return STG_E_INVALIDFUNCTION;
+        if (plibNewPosition) plibNewPosition->QuadPart = _position;
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE PushStream::Stat(STATSTG *pstatstg, DWORD)
+    {
+        if (!pstatstg) return STG_E_INVALIDPOINTER;
+        memset(pstatstg, 0, sizeof(STATSTG));
+        pstatstg->type = STGTY_STREAM;
+        pstatstg->cbSize.QuadPart = 0;
+        return S_OK;
+    }
+
+    ULONG STDMETHODCALLTYPE PushStream::Release()
+    {
+        ULONG ref = InterlockedDecrement(&_refCount);
+        if (ref == 0)
+        {
+            close_push_channel(_channel);
+            unref_push_channel(_channel);
+            acul::release(this);
+        }
+        return ref;
+    }
+
+    HRESULT STDMETHODCALLTYPE PushStream::QueryInterface(REFIID riid, void **ppvObject)
+    {
+        if (riid == IID_IUnknown || riid == IID_ISequentialStream || riid == IID_IStream)
+        {
+            *ppvObject = static_cast<IStream *>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppvObject = nullptr;
+        return E_NOINTERFACE;
+    }
+
     acul::string url_to_path(LPCWSTR url)
     {
         acul::wstring wurl(url);
@@ -60,7 +109,8 @@ namespace alwf
         return acul::utf16_to_utf8(acul::u16string(wurl.begin() + offset, wurl.end()));
     }
 
-    void create_web_response(IResponse *res, Microsoft::WRL::ComPtr<ICoreWebView2WebResourceResponse> &res_raw)
+    void create_web_response(IResponse *res, Microsoft::WRL::ComPtr<ICoreWebView2WebResourceResponse> &res_raw,
+                             const char *link = nullptr)
     {
         Microsoft::WRL::ComPtr<IStream> stream;
         size_t size = res->size();
@@ -69,7 +119,8 @@ namespace alwf
         memcpy(pMem, res->data(), size);
         GlobalUnlock(hMem);
         CreateStreamOnHGlobal(hMem, TRUE, &stream);
-        acul::string headers = acul::format("Content-Type: %s\r\nContent-Length: %d", res->content_type, size);
+        acul::string headers = acul::format("Content-Type: %s\r\nContent-Length: %zu", res->content_type, size);
+        if (link) headers.append(acul::format("\r\nLink: %s", link));
         acul::u16string w_headers = acul::utf8_to_utf16(headers);
         platform.webViewEnvironment->CreateWebResourceResponse(stream.Get(), 200, L"OK", (LPWSTR)w_headers.c_str(),
                                                                &res_raw);
@@ -104,30 +155,55 @@ namespace alwf
         return out;
     }
 
-    static bool wants_json_from(const Request &req)
+    static void create_dispatch_response(const DispatchResult &result, WindowId window,
+                                         Microsoft::WRL::ComPtr<ICoreWebView2WebResourceResponse> &response)
+    {
+        switch (result.kind)
+        {
+            case DispatchKind::owned:
+                create_web_response(result.res, response, result.link);
+                acul::release(result.res);
+                break;
+            case DispatchKind::cached:
+                create_web_response(result.res, response);
+                break;
+            case DispatchKind::stream:
+            {
+                Microsoft::WRL::ComPtr<IStream> stream;
+                stream.Attach(acul::alloc<PushStream>(open_push_channel(window)));
+                platform.webViewEnvironment->CreateWebResourceResponse(
+                    stream.Get(), 200, L"OK", L"Content-Type: application/x-ndjson\r\nCache-Control: no-store",
+                    &response);
+                break;
+            }
+            default:
+                platform.webViewEnvironment->CreateWebResourceResponse(nullptr, 404, L"Not Found",
+                                                                       L"Content-Type: text/html", &response);
+                break;
+        }
+    }
+
+    // ----------------------------------------------------
+    // NavigationStartingHandler
+    // ----------------------------------------------------
+    HRESULT STDMETHODCALLTYPE NavigationStartingHandler::Invoke(ICoreWebView2 *,
+                                                                ICoreWebView2NavigationStartingEventArgs *)
     {
-        auto accept = req.get_header(ACUL_C_STR("Accept"));
-        if (!accept.empty() && acul::find_insensitive_case(accept, "application/json") != acul::string::npos)
-            return true;
-        auto xrw = req.get_header(ACUL_C_STR("X-Requested-With"));
-        if (!xrw.empty() && (stricmp(xrw.data(), "fetch") || stricmp(xrw.data(), "XMLHttpRequest"))) return true;
-        return false;
+        drop_window_calls(_window);
+        return S_OK;
     }
 
-    IResponse *emit_error(const Request &req, const char *err)
+    HRESULT STDMETHODCALLTYPE NavigationStartingHandler::QueryInterface(REFIID riid, void **ppvObject)
     {
-        LOG_ERROR("%s", err);
-        if (wants_json_from(req))
+        if (!memcmp(&riid, &IID_IUnknown, sizeof(GUID)) ||
+            !memcmp(&riid, &IID_ICoreWebView2NavigationStartingEventHandler, sizeof(GUID)))
         {
-            rapidjson::Document d;
-            d.SetObject();
-            auto &a = d.GetAllocator();
-            d.AddMember("success", false, a);
-            rapidjson::Value e(err, a);
-            d.AddMember("error", e, a);
-            return acul::alloc<JSONResponse>(std::move(d));
+            *ppvObject = static_cast<ICoreWebView2NavigationStartingEventHandler *>(this);
+            AddRef();
+            return S_OK;
         }
-        else return acul::alloc<TextResponse>(err, "text/plain");
+        *ppvObject = nullptr;
+        return E_NOINTERFACE;
     }
 
     // ----------------------------------------------------
@@ -161,49 +237,24 @@ namespace alwf
         request_raw->get_Headers(&headers);
         req.request_ctx = (void *)headers.Get();
 
-        Router::route_store *router = nullptr;
-        switch (req.method)
-        {
-            case Method::get:
-                router = &ctx->router->get;
-                break;
-            case Method::post:
-                router = &ctx->router->post;
-                break;
-            case Method::put:
-                router = &ctx->router->put;
-                break;
-            case Method::del:
-                router = &ctx->router->del;
-                break;
-            default:
-                return S_OK;
-        }
-
-        auto it = router->find(path);
-        if (it != router->end())
-        {
-            IResponse *res = nullptr;
-            try
-            {
-                res = it->second(req);
-                if (!res) res = emit_error(req, "Route handler returned null response");
-            }
-            catch (const std::exception &e)
-            {
-                res = emit_error(req, e.what());
-            }
-            create_web_response(res, response);
-            acul::release(res);
-        }
-        else
+        WindowScope scope(_window);
+        DispatchResult result = dispatch_request(req);
+        if (result.kind == DispatchKind::deferred)
         {
-            if (auto *res = load_static_file(path)) create_web_response(res, response);
-            else
-                platform.webViewEnvironment->CreateWebResourceResponse(nullptr, 404, L"Not Found",
-                                                                       L"Content-Type: text/html", &response);
+            // A coroutine route suspended: defer the event and keep the headers the coroutine reads alive until it
+            // completes
+            Microsoft::WRL::ComPtr<ICoreWebView2Deferral> deferral;
+            args->GetDeferral(&deferral);
+            Microsoft::WRL::ComPtr<ICoreWebView2WebResourceRequestedEventArgs> event(args);
+            result.pending->finish = [event, deferral, headers, window = _window](const DispatchResult &done) {
+                Microsoft::WRL::ComPtr<ICoreWebView2WebResourceResponse> response;
+                create_dispatch_response(done, window, response);
+                event->put_Response(response.Get());
+                deferral->Complete();
+            };
+            return S_OK;
         }
-
+        create_dispatch_response(result, _window, response);
         args->put_Response(response.Get());
         return S_OK;
     }
@@ -241,16 +292,19 @@ namespace alwf
     acul::string Request::get_header(const ACUL_NATIVE_CHAR *header) const
     {
         using Microsoft::WRL::ComPtr;
+        if (headers && header)
+            return find_header(*headers,
+                               acul::utf16_to_utf8(reinterpret_cast<const std::u16string::value_type *>(header)).c_str());
         if (!request_ctx || !header) return {};
 
-        auto *headers = static_cast<ICoreWebView2HttpRequestHeaders *>(request_ctx);
-        if (LPWSTR val = nullptr; SUCCEEDED(headers->GetHeader((LPWSTR)header, &val)) && val)
+        auto *native = static_cast<ICoreWebView2HttpRequestHeaders *>(request_ctx);
+        if (LPWSTR val = nullptr; SUCCEEDED(native->GetHeader((LPWSTR)header, &val)) && val)
         {
             acul::string out = acul::utf16_to_utf8(reinterpret_cast<const std::u16string::value_type *>(val));
             CoTaskMemFree(val);
             return out;
         }
-        return get_header_case_insensitive(headers, (LPWSTR)header);
+        return get_header_case_insensitive(native, (LPWSTR)header);
     }
 
     // ----------------------------------------------------
@@ -260,29 +314,41 @@ namespace alwf
     {
         if (!controller) return E_FAIL;
 
-        platform.webViewController = controller;
+        // The window may have been closed while its view was being created
+        auto view = platform.views.find(_window);
+        if (view == platform.views.end())
+        {
+            controller->Close();
+            return S_OK;
+        }
+        view->second.webViewController = controller;
         controller->AddRef();
         Microsoft::WRL::ComPtr<ICoreWebView2> webView;
         controller->get_CoreWebView2(&webView);
         Microsoft::WRL::ComPtr<ICoreWebView2Settings> settings;
         webView->get_Settings(&settings);
         settings->put_IsWebMessageEnabled(TRUE);
-        platform.webView = webView.Get();
-        EventRegistrationToken tokens[2];
+        view->second.webView = webView.Get();
+        EventRegistrationToken tokens[3];
 
         Microsoft::WRL::ComPtr<WebResourceRequestedHandler> handler;
-        handler.Attach(acul::alloc<WebResourceRequestedHandler>());
+        handler.Attach(acul::alloc<WebResourceRequestedHandler>(_window));
         webView->AddWebResourceRequestedFilter(L"file://localhost/*", COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
         webView->add_WebResourceRequested(handler.Get(), &tokens[0]);
 
         Microsoft::WRL::ComPtr<WebMessageHandler> messageHandler;
-        messageHandler.Attach(acul::alloc<WebMessageHandler>());
+        messageHandler.Attach(acul::alloc<WebMessageHandler>(_window));
         webView->add_WebMessageReceived(messageHandler.Get(), &tokens[1]);
 
-        webView->Navigate(L"file://localhost/");
+        Microsoft::WRL::ComPtr<NavigationStartingHandler> navigationHandler;
+        navigationHandler.Attach(acul::alloc<NavigationStartingHandler>(_window));
+        webView->add_NavigationStarting(navigationHandler.Get(), &tokens[2]);
+
+        acul::u16string url = acul::utf8_to_utf16(acul::format("file://localhost%s", view->second.path.c_str()));
+        webView->Navigate((LPCWSTR)url.c_str());
 
         RECT bounds;
-        GetClientRect(_hwnd, &bounds);
+        GetClientRect(view->second.hwnd, &bounds);
         controller->put_Bounds(bounds);
         return S_OK;
     }
@@ -303,12 +369,18 @@ namespace alwf
     // ----------------------------------------------------
     // WebView2EnvHandler
     // ----------------------------------------------------
+    static void create_controller(WindowId id, HWND hwnd)
+    {
+        platform.webViewEnvironment->CreateCoreWebView2Controller(hwnd, acul::alloc<WebView2ControllerHandler>(id));
+    }
+
     HRESULT STDMETHODCALLTYPE WebView2EnvHandler::Invoke(HRESULT result, ICoreWebView2Environment *env)
     {
         if (env)
         {
-            env->CreateCoreWebView2Controller(_hwnd, acul::alloc<WebView2ControllerHandler>(_hwnd));
             platform.webViewEnvironment = env;
+            // Every window opened while the environment was starting
+            for (auto &[id, view] : platform.views) create_controller(id, view.hwnd);
         }
         return S_OK;
     }
@@ -326,12 +398,60 @@ namespace alwf
         return E_NOINTERFACE;
     }
 
+    static HANDLE low_memory = nullptr;
+    static HANDLE stop_memory_watch = nullptr;
+    static std::thread memory_watch;
+
+    // The notification stays signaled while memory is low, so the watcher backs off before waiting on it again
+    static void watch_memory_pressure()
+    {
+        low_memory = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+        stop_memory_watch = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!low_memory || !stop_memory_watch) return;
+        memory_watch = std::thread([] {
+            HANDLE handles[2] = {stop_memory_watch, low_memory};
+            while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+            {
+                post_to_main([] {
+                    LOG_WARN("Low memory warning");
+                    trim_memory();
+                });
+                if (WaitForSingleObject(stop_memory_watch, 30000) == WAIT_OBJECT_0) break;
+            }
+        });
+    }
+
+    void set_web_memory_low(bool low)
+    {
+        for (auto &[id, view] : platform.views)
+        {
+            Microsoft::WRL::ComPtr<ICoreWebView2_19> webView19;
+            if (!view.webView || FAILED(view.webView.As(&webView19))) continue;
+            webView19->put_MemoryUsageTargetLevel(low ? COREWEBVIEW2_MEMORY_USAGE_TARGET_LEVEL_LOW
+                                                      : COREWEBVIEW2_MEMORY_USAGE_TARGET_LEVEL_NORMAL);
+        }
+    }
+
+    // WebView2 exposes no script GC; the low memory target level is what makes the browser process trim
+    void collect_web_garbage() {}
+
     using CreateEnvFn = HRESULT(WINAPI *)(LPCWSTR, LPCWSTR, ICoreWebView2EnvironmentOptions *,
                                           ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler *);
 
-    void init_web_view(awin::Window *window)
+    void init_web_view(WindowId id, awin::Window *window, const char *path)
     {
         HWND hwnd = awin::native_access::get_hwnd(*window);
+        if (id == main_window) platform.hwnd = hwnd;
+        auto &view = platform.views[id];
+        view.hwnd = hwnd;
+        view.path = path && *path ? path : "/";
+        if (platform.webViewEnvironment)
+        {
+            create_controller(id, hwnd);
+            return;
+        }
+        if (platform.environment_requested) return;
+
         HMODULE hWebView2 = LoadLibraryExW(L"WebView2Loader.dll", NULL, LOAD_LIBRARY_SEARCH_DEFAULT_DIRS);
         if (!hWebView2)
         {
@@ -346,47 +466,151 @@ namespace alwf
             return;
         }
         LPCWSTR cache = L"./cache";
-        createEnv(nullptr, cache, nullptr, acul::alloc<WebView2EnvHandler>(hwnd));
+        createEnv(nullptr, cache, nullptr, acul::alloc<WebView2EnvHandler>());
+        platform.environment_requested = true;
+        watch_memory_pressure();
+    }
+
+    void destroy_web_view(WindowId id)
+    {
+        auto it = platform.views.find(id);
+        if (it == platform.views.end()) return;
+        if (it->second.webViewController) it->second.webViewController->Close();
+        platform.views.erase(it);
     }
 
     void destroy_platform()
     {
-        platform.webView.Reset();
-        platform.webViewController.Reset();
+        if (stop_memory_watch) SetEvent(stop_memory_watch);
+        if (memory_watch.joinable()) memory_watch.join();
+        if (low_memory) CloseHandle(low_memory);
+        if (stop_memory_watch) CloseHandle(stop_memory_watch);
+        low_memory = stop_memory_watch = nullptr;
+        platform.views.clear();
         platform.webViewEnvironment.Reset();
     }
 
-    void send_json_to_frontend(const rapidjson::Value &json)
+    void send_raw_to_frontend(const acul::string &json, WindowId window)
+    {
+        capture_message(CaptureKind::outbound, json.c_str(), json.size());
+        acul::u16string wJson = acul::utf8_to_utf16(json);
+        for (auto &[id, view] : platform.views)
+            if ((window == all_windows || window == id) && view.webView)
+                view.webView->PostWebMessageAsJson((LPCWSTR)wJson.c_str());
+    }
+
+    void send_json_to_window(WindowId id, const rapidjson::Value &json)
     {
         rapidjson::StringBuffer buffer;
         rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
         json.Accept(writer);
-        acul::u16string wJson = acul::utf8_to_utf16(buffer.GetString());
-        platform.webView->PostWebMessageAsJson((LPCWSTR)wJson.c_str());
+        send_raw_to_frontend(acul::string(buffer.GetString(), buffer.GetSize()), id);
     }
 
-    void on_resize(awin::Window *window, acul::point2D<i32> size)
+    void send_json_to_frontend(const rapidjson::Value &json) { send_json_to_window(all_windows, json); }
+
+    static std::mutex main_queue_lock;
+    static acul::vector<std::function<void()>> main_queue;
+    static acul::vector<std::function<void()>> idle_queue;
+
+    void post_to_main(std::function<void()> &&task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(main_queue_lock);
+            main_queue.push_back(std::move(task));
+        }
+        if (platform.hwnd) PostMessageW(platform.hwnd, WM_NULL, 0, 0);
+    }
+
+    void post_idle(std::function<void()> &&task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(main_queue_lock);
+            idle_queue.push_back(std::move(task));
+        }
+        if (platform.hwnd) PostMessageW(platform.hwnd, WM_NULL, 0, 0);
+    }
+
+    void dispatch_main_queue()
+    {
+        acul::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(main_queue_lock);
+            tasks.swap(main_queue);
+        }
+        for (auto &task : tasks) task();
+
+        // One idle task per loop iteration, and only while no input is waiting
+        if (HIWORD(GetQueueStatus(QS_ALLINPUT)) != 0) return;
+        std::function<void()> idle;
+        bool more = false;
+        {
+            std::lock_guard<std::mutex> lock(main_queue_lock);
+            if (idle_queue.empty()) return;
+            idle = std::move(idle_queue.front());
+            idle_queue.erase(idle_queue.begin());
+            more = !idle_queue.empty();
+        }
+        idle();
+        if (more && platform.hwnd) PostMessageW(platform.hwnd, WM_NULL, 0, 0);
+    }
+
+    // Thread timers fire from the message loop, so the tasks run on the main thread like queued ones
+    static acul::hashmap<UINT_PTR, std::function<void()>> timers;
+
+    void post_delayed(u32 ms, std::function<void()> &&task)
     {
-        if (!platform.webViewController) return;
+        UINT_PTR id = SetTimer(nullptr, 0, ms, [](HWND, UINT, UINT_PTR id, DWORD) {
+            KillTimer(nullptr, id);
+            auto it = timers.find(id);
+            if (it == timers.end()) return;
+            auto fire = std::move(it->second);
+            timers.erase(it);
+            fire();
+        });
+        if (id) timers.emplace(id, std::move(task));
+        else post_to_main(std::move(task));
+    }
 
+    static Win32WebView *find_view(awin::Window *window, WindowId &id)
+    {
         HWND hwnd = awin::native_access::get_hwnd(*window);
-        if (!hwnd) return;
+        if (!hwnd) return nullptr;
+        for (auto &[view_id, view] : platform.views)
+            if (view.hwnd == hwnd)
+            {
+                id = view_id;
+                return view.webViewController ? &view : nullptr;
+            }
+        return nullptr;
+    }
+
+    void on_resize(awin::Window *window, acul::point2D<i32> size)
+    {
+        WindowId id;
+        Win32WebView *view = find_view(window, id);
+        if (!view) return;
 
+        // A zero size means the window was minimized
         if (size.x <= 0 || size.y <= 0)
         {
             RECT rc{0, 0, 1, 1};
-            platform.webViewController->put_Bounds(rc);
+            view->webViewController->put_Bounds(rc);
+            view->webViewController->put_IsVisible(FALSE);
+            on_window_visibility(id, false);
             return;
         }
+        view->webViewController->put_IsVisible(TRUE);
+        on_window_visibility(id, true);
 
         RECT bounds{0, 0, size.x, size.y};
-        platform.webViewController->put_Bounds(bounds);
-        platform.webViewController->NotifyParentWindowPositionChanged();
+        view->webViewController->put_Bounds(bounds);
+        view->webViewController->NotifyParentWindowPositionChanged();
     }
 
-    void on_move()
+    void on_move(awin::Window *window)
     {
-        if (!platform.webViewController) return;
-        platform.webViewController->NotifyParentWindowPositionChanged();
+        WindowId id;
+        if (Win32WebView *view = find_view(window, id)) view->webViewController->NotifyParentWindowPositionChanged();
     }
 } // namespace alwf
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <windows.h>
+#include "../framework.hpp"
+
+namespace alwf
+{
+    static HANDLE main_thread = nullptr;
+
+    void init_stack_sampler()
+    {
+        if (main_thread) return;
+        main_thread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION, FALSE,
+                                 GetCurrentThreadId());
+    }
+
+    bool sample_main_stack(acul::string &out)
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        if (!main_thread) return false;
+        DWORD64 frames[64];
+        int n = 0;
+        if (SuspendThread(main_thread) == (DWORD)-1) return false;
+
+        // Nothing may allocate until the thread is resumed: it can be holding the heap lock
+        CONTEXT c{};
+        c.ContextFlags = CONTEXT_FULL;
+        if (GetThreadContext(main_thread, &c))
+        {
+            while (n < 64 && c.Rip)
+            {
+                frames[n++] = c.Rip;
+                DWORD64 image = 0;
+                PRUNTIME_FUNCTION fn = RtlLookupFunctionEntry(c.Rip, &image, nullptr);
+                if (!fn)
+                {
+                    // Leaf function: the return address is on top of the stack
+                    c.Rip = *reinterpret_cast<DWORD64 *>(c.Rsp);
+                    c.Rsp += 8;
+                    continue;
+                }
+                void *handler_data = nullptr;
+                DWORD64 establisher = 0;
+                RtlVirtualUnwind(UNW_FLAG_NHANDLER, image, c.Rip, fn, &c, &handler_data, &establisher, nullptr);
+            }
+        }
+        ResumeThread(main_thread);
+
+        for (int i = 0; i < n; ++i)
+        {
+            HMODULE module = nullptr;
+            char name[MAX_PATH] = "?";
+            if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                   reinterpret_cast<LPCSTR>(frames[i]), &module))
+                GetModuleFileNameA(module, name, MAX_PATH);
+            const char *base = strrchr(name, '\\');
+            out.append(acul::format("%s+0x%llx\n", base ? base + 1 : name,
+                                    (unsigned long long)(frames[i] - reinterpret_cast<DWORD64>(module))));
+        }
+        return n > 0;
+#else
+        return false;
+#endif
+    }
+} // namespace alwf
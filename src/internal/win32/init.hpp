@@ -1,19 +1,55 @@
 #pragma once
 #include <WebView2.h>
 #include <acul/memory/alloc.hpp>
+#include <alwf/alwf.hpp>
 #include <windows.h>
 #include <wrl.h>
 #include <wrl/client.h>
 
 namespace alwf
 {
+    struct PushChannel;
+
+    // ----------------------------------------------------
+    // PushStream
+    // ----------------------------------------------------
+    class PushStream final : public IStream
+    {
+    public:
+        explicit PushStream(PushChannel *channel) : _channel(channel), _refCount(1) {}
+
+        HRESULT STDMETHODCALLTYPE Read(void *pv, ULONG cb, ULONG *pcbRead) override;
+        HRESULT STDMETHODCALLTYPE Write(const void *, ULONG, ULONG *) override { return STG_E_ACCESSDENIED; }
+        HRESULT STDMETHODCALLTYPE Seek(LARGE_INTEGER dlibMove, DWORD dwOrigin, ULARGE_INTEGER *plibNewPosition) override;
+        HRESULT STDMETHODCALLTYPE SetSize(ULARGE_INTEGER) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE CopyTo(IStream *, ULARGE_INTEGER, ULARGE_INTEGER *, ULARGE_INTEGER *) override
+        {
+            return E_NOTIMPL;
+        }
+        HRESULT STDMETHODCALLTYPE Commit(DWORD) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE Revert() override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return E_NOTIMPL; }
+        HRESULT STDMETHODCALLTYPE Stat(STATSTG *pstatstg, DWORD grfStatFlag) override;
+        HRESULT STDMETHODCALLTYPE Clone(IStream **) override { return E_NOTIMPL; }
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&_refCount); }
+        ULONG STDMETHODCALLTYPE Release() override;
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObject) override;
+
+    private:
+        PushChannel *_channel;
+        ULONGLONG _position = 0;
+        LONG _refCount;
+    };
+
     // ----------------------------------------------------
     // WebMessageHandler
     // ----------------------------------------------------
     class WebMessageHandler final : public ICoreWebView2WebMessageReceivedEventHandler
     {
     public:
-        WebMessageHandler() : _refCount(1) {}
+        explicit WebMessageHandler(WindowId window) : _window(window), _refCount(1) {}
 
         HRESULT STDMETHODCALLTYPE Invoke(ICoreWebView2 *sender,
                                          ICoreWebView2WebMessageReceivedEventArgs *args) override;
@@ -28,6 +64,32 @@ namespace alwf
         HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObject) override;
 
     private:
+        WindowId _window;
+        LONG _refCount;
+    };
+
+    // ----------------------------------------------------
+    // NavigationStartingHandler
+    // ----------------------------------------------------
+    class NavigationStartingHandler final : public ICoreWebView2NavigationStartingEventHandler
+    {
+    public:
+        explicit NavigationStartingHandler(WindowId window) : _window(window), _refCount(1) {}
+
+        HRESULT STDMETHODCALLTYPE Invoke(ICoreWebView2 *sender,
+                                         ICoreWebView2NavigationStartingEventArgs *args) override;
+
+        ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&_refCount); }
+        ULONG STDMETHODCALLTYPE Release() override
+        {
+            ULONG ref = InterlockedDecrement(&_refCount);
+            if (ref == 0) acul::release(this);
+            return ref;
+        }
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObject) override;
+
+    private:
+        WindowId _window;
         LONG _refCount;
     };
 
@@ -37,7 +99,7 @@ namespace alwf
     class WebResourceRequestedHandler : public ICoreWebView2WebResourceRequestedEventHandler
     {
     public:
-        WebResourceRequestedHandler() : _refCount(1) {}
+        explicit WebResourceRequestedHandler(WindowId window) : _window(window), _refCount(1) {}
 
         HRESULT STDMETHODCALLTYPE Invoke(ICoreWebView2 *sender,
                                          ICoreWebView2WebResourceRequestedEventArgs *args) override;
@@ -62,6 +124,7 @@ namespace alwf
         }
 
     private:
+        WindowId _window;
         LONG _refCount;
     };
 
@@ -71,7 +134,7 @@ namespace alwf
     class WebView2ControllerHandler final : public ICoreWebView2CreateCoreWebView2ControllerCompletedHandler
     {
     public:
-        WebView2ControllerHandler(HWND hwnd) : _hwnd(hwnd), _refCount(1) {}
+        explicit WebView2ControllerHandler(WindowId window) : _window(window), _refCount(1) {}
 
         HRESULT STDMETHODCALLTYPE Invoke(HRESULT result, ICoreWebView2Controller *controller) override;
         ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&_refCount); }
@@ -84,7 +147,7 @@ namespace alwf
         HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObject) override;
 
     private:
-        HWND _hwnd;
+        WindowId _window;
         ULONG _refCount;
     };
 
@@ -94,7 +157,7 @@ namespace alwf
     class WebView2EnvHandler final : public ICoreWebView2CreateCoreWebView2EnvironmentCompletedHandler
     {
     public:
-        WebView2EnvHandler(HWND hwnd) : _hwnd(hwnd), _refCount(1) {}
+        WebView2EnvHandler() : _refCount(1) {}
 
         HRESULT STDMETHODCALLTYPE Invoke(HRESULT result, ICoreWebView2Environment *env) override;
         ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&_refCount); }
@@ -107,7 +170,6 @@ namespace alwf
         HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObject) override;
 
     private:
-        HWND _hwnd;
         ULONG _refCount;
     };
 } // namespace alwf
\ No newline at end of file
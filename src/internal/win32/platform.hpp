@@ -1,13 +1,24 @@
 #pragma once
 #include <WebView2.h>
+#include <alwf/alwf.hpp>
 #include <wrl/client.h>
 
 namespace alwf
 {
-    extern struct Win32PlatformData
+    // Controller and view are null until the shared environment has created them
+    struct Win32WebView
     {
+        HWND hwnd = nullptr;
+        acul::string path;
         Microsoft::WRL::ComPtr<ICoreWebView2Controller> webViewController = nullptr;
         Microsoft::WRL::ComPtr<ICoreWebView2> webView = nullptr;
-        Microsoft::WRL::ComPtr<ICoreWebView2Environment> webViewEnvironment = nullptr;
+    };
+
+    extern struct Win32PlatformData
+    {
+        Microsoft::WRL::ComPtr<ICoreWebView2Environment> webViewEnvironment = nullptr; // shared by every window
+        bool environment_requested = false;
+        HWND hwnd = nullptr; // the main window, woken for main-thread tasks
+        acul::hashmap<WindowId, Win32WebView> views;
     } platform;
 } // namespace alwf
\ No newline at end of file
@@ -0,0 +1,536 @@
+#ifdef _WIN32
+    #include <winsock2.h> // ahead of windows.h, which would pull in the old winsock.h
+    #include <windows.h>
+#else
+    #include <climits>
+    #include <csignal>
+    #include <spawn.h>
+    #include <sys/wait.h>
+extern char **environ;
+#endif
+#include <acul/log.hpp>
+#include <acul/string/utils.hpp>
+#include <algorithm>
+#include <alwf/worker.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "framework.hpp"
+#include "net.hpp"
+
+namespace alwf
+{
+#ifdef _WIN32
+    using process_t = HANDLE;
+    static socket_t open_socket() { return socket(AF_INET, SOCK_STREAM, 0); }
+    static socket_t accept_socket(socket_t listener) { return accept(listener, nullptr, nullptr); }
+#else
+    using process_t = pid_t;
+    // Close-on-exec, so workers started later do not inherit each other's connections
+    static socket_t open_socket() { return socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0); }
+    static socket_t accept_socket(socket_t listener) { return accept4(listener, nullptr, nullptr, SOCK_CLOEXEC); }
+#endif
+
+    static constexpr const char *worker_env = "ALWF_WORKER";
+    static constexpr u32 connect_timeout_ms = 10000;
+    static constexpr u32 restart_delay_ms = 500;
+
+    // Wire format between the UI process and its workers. Both ends are the same executable, so the headers are sent
+    // as they are laid out in memory.
+    struct JobHeader
+    {
+        u32 method;
+        u32 name_size;
+        u32 path_size;
+        u32 query_size;
+        u32 headers_size; // "name\0value\0" pairs
+        u64 body_size;
+    };
+
+    struct ResultHeader
+    {
+        u32 failed; // the body is the error message
+        u32 type_size;
+        u64 body_size;
+    };
+
+    static bool send_all(socket_t fd, const char *data, size_t len)
+    {
+        while (len)
+        {
+            auto n = send(fd, data, (int)std::min<size_t>(len, 1 << 20), send_flags);
+            if (n <= 0) return false;
+            data += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    // Blocks until len bytes have arrived. False on EOF or error, when stop is set, or when timeout_ms passes; a
+    // zero timeout waits forever.
+    static bool read_exact(socket_t fd, char *dst, size_t len, u32 timeout_ms, const std::atomic<bool> *stop = nullptr)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        while (len)
+        {
+            pollfd_t p{fd, POLLIN, 0};
+            int ready = poll_sockets(&p, 1, 250);
+            if (stop && stop->load(std::memory_order_acquire)) return false;
+            if (timeout_ms && std::chrono::steady_clock::now() > deadline) return false;
+            if (ready <= 0) continue;
+            auto n = recv(fd, dst, (int)std::min<size_t>(len, 1 << 20), 0);
+            if (n <= 0) return false;
+            dst += n;
+            len -= (size_t)n;
+        }
+        return true;
+    }
+
+    static bool send_result(socket_t fd, bool failed, const char *type, const char *data, size_t size)
+    {
+        ResultHeader h{failed ? 1u : 0u, (u32)strlen(type), size};
+        return send_all(fd, (const char *)&h, sizeof(h)) && send_all(fd, type, h.type_size) &&
+               send_all(fd, data, size);
+    }
+
+    // ----------------------------------------------------
+    // Worker process
+    // ----------------------------------------------------
+    static IResponse *run_job(const WorkerRouter &jobs, const acul::string &name, const Request &req)
+    {
+        auto it = jobs.find(name);
+        if (it == jobs.end()) throw std::runtime_error(acul::format("Unknown worker job %s", name.c_str()).c_str());
+        IResponse *res = it->second(req);
+        if (!res) throw std::runtime_error("Worker job returned null response");
+        if (dynamic_cast<PendingResponse *>(res))
+        {
+            acul::release(res);
+            throw std::runtime_error("Worker jobs cannot be coroutine routes");
+        }
+        return res;
+    }
+
+    bool serve_worker(const WorkerRouter &jobs)
+    {
+        const char *endpoint = getenv(worker_env);
+        if (!endpoint) return false;
+        unsigned port = 0;
+        unsigned long long token = 0;
+        if (sscanf(endpoint, "%u:%llx", &port, &token) != 2) return false;
+
+#ifdef _WIN32
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return true;
+#endif
+        socket_t fd = open_socket();
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons((u16)port);
+        const u64 hello = token;
+        if (fd == INVALID_SOCKET || connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0 ||
+            !send_all(fd, (const char *)&hello, sizeof(hello)))
+        {
+            if (fd != INVALID_SOCKET) close_socket(fd);
+            return true;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char *)&on, sizeof(on));
+
+        for (;;)
+        {
+            JobHeader h;
+            if (!read_exact(fd, (char *)&h, sizeof(h), 0)) break;
+            acul::string name(h.name_size, '\0'), path(h.path_size, '\0'), query(h.query_size, '\0');
+            acul::string headers(h.headers_size, '\0');
+            Request req;
+            req.body.resize(h.body_size);
+            if (!read_exact(fd, name.data(), name.size(), 0) || !read_exact(fd, path.data(), path.size(), 0) ||
+                !read_exact(fd, query.data(), query.size(), 0) ||
+                !read_exact(fd, headers.data(), headers.size(), 0) || !read_exact(fd, req.body.data(), h.body_size, 0))
+                break;
+
+            HeaderMap header_map;
+            for (size_t pos = 0; pos < headers.size();)
+            {
+                const char *key = headers.c_str() + pos;
+                const char *value = key + strlen(key) + 1;
+                header_map[key] = value;
+                pos = (size_t)(value - headers.c_str()) + strlen(value) + 1;
+            }
+            req.method = (Method)h.method;
+            req.path = std::move(path);
+            req.query = std::move(query);
+            req.request_ctx = nullptr;
+            req.headers = &header_map;
+
+            bool sent;
+            try
+            {
+                IResponse *res = run_job(jobs, name, req);
+                sent = send_result(fd, false, res->content_type ? res->content_type : "application/octet-stream",
+                                   res->data(), res->size());
+                acul::release(res);
+            }
+            catch (const std::exception &e)
+            {
+                sent = send_result(fd, true, "text/plain", e.what(), strlen(e.what()));
+            }
+            catch (...)
+            {
+                sent = send_result(fd, true, "text/plain", "Unknown error", 13);
+            }
+            if (!sent) break;
+        }
+        close_socket(fd);
+        return true;
+    }
+
+    // ----------------------------------------------------
+    // Pool in the UI process
+    // ----------------------------------------------------
+    struct WorkerSlot
+    {
+        std::thread thread;
+        socket_t listener = INVALID_SOCKET;
+        socket_t conn = INVALID_SOCKET;
+        process_t process{};
+        bool running = false;
+    };
+
+    static struct WorkerPool
+    {
+        std::mutex lock;
+        std::condition_variable cv;
+        acul::vector<detail::WorkerJob *> queue;
+        acul::vector<WorkerSlot *> slots;
+        std::atomic<bool> stopping{false};
+        u32 timeout_ms = 0;
+        u64 token = 0;
+    } *pool = nullptr;
+
+    static std::mutex spawn_lock;
+
+    // Starts this executable again with ALWF_WORKER pointing at the slot's listener
+    static bool spawn_process(const acul::string &endpoint, process_t &process)
+    {
+        std::lock_guard<std::mutex> lock(spawn_lock);
+#ifdef _WIN32
+        wchar_t exe[MAX_PATH];
+        if (!GetModuleFileNameW(nullptr, exe, MAX_PATH)) return false;
+        // Inherited through the environment block; set only while the child is created
+        acul::u16string value = acul::utf8_to_utf16(endpoint);
+        SetEnvironmentVariableW(L"ALWF_WORKER", (LPCWSTR)value.c_str());
+        STARTUPINFOW si{};
+        si.cb = sizeof(si);
+        PROCESS_INFORMATION pi{};
+        BOOL ok = CreateProcessW(exe, nullptr, nullptr, nullptr, FALSE, CREATE_NO_WINDOW | BELOW_NORMAL_PRIORITY_CLASS,
+                                 nullptr, nullptr, &si, &pi);
+        SetEnvironmentVariableW(L"ALWF_WORKER", nullptr);
+        if (!ok) return false;
+        CloseHandle(pi.hThread);
+        process = pi.hProcess;
+        return true;
+#else
+        char exe[PATH_MAX];
+        ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+        if (n <= 0) return false;
+        exe[n] = '\0';
+        acul::string var = acul::format("%s=%s", worker_env, endpoint.c_str());
+        acul::vector<char *> env;
+        for (char **e = environ; *e; ++e)
+            if (strncmp(*e, var.c_str(), strlen(worker_env) + 1) != 0) env.push_back(*e);
+        env.push_back(var.data());
+        env.push_back(nullptr);
+        char *argv[] = {exe, nullptr};
+        return posix_spawn(&process, exe, nullptr, nullptr, argv, env.data()) == 0;
+#endif
+    }
+
+    static void kill_process(process_t process)
+    {
+#ifdef _WIN32
+        TerminateProcess(process, 1);
+        WaitForSingleObject(process, INFINITE);
+        CloseHandle(process);
+#else
+        kill(process, SIGKILL);
+        waitpid(process, nullptr, 0);
+#endif
+    }
+
+    static void stop_slot_process(WorkerSlot &slot)
+    {
+        if (slot.conn != INVALID_SOCKET) close_socket(slot.conn);
+        slot.conn = INVALID_SOCKET;
+        if (slot.running) kill_process(slot.process);
+        slot.running = false;
+    }
+
+    static bool open_listener(WorkerSlot &slot, u16 &port)
+    {
+        if (slot.listener == INVALID_SOCKET)
+        {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            slot.listener = open_socket();
+            if (slot.listener == INVALID_SOCKET) return false;
+            if (bind(slot.listener, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(slot.listener, 4) != 0)
+            {
+                close_socket(slot.listener);
+                slot.listener = INVALID_SOCKET;
+                return false;
+            }
+        }
+        sockaddr_in addr{};
+        socklen_t len = sizeof(addr);
+        getsockname(slot.listener, (sockaddr *)&addr, &len);
+        port = ntohs(addr.sin_port);
+        return true;
+    }
+
+    // Starts a worker and waits for it to connect back with the pool's token
+    static bool launch_worker(WorkerSlot &slot)
+    {
+        u16 port;
+        if (!open_listener(slot, port)) return false;
+        if (!spawn_process(acul::format("%u:%llx", (unsigned)port, (unsigned long long)pool->token), slot.process))
+            return false;
+        slot.running = true;
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(connect_timeout_ms);
+        while (!pool->stopping.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline)
+        {
+            pollfd_t p{slot.listener, POLLIN, 0};
+            if (poll_sockets(&p, 1, 250) <= 0) continue;
+            socket_t fd = accept_socket(slot.listener);
+            if (fd == INVALID_SOCKET) continue;
+            u64 hello = 0;
+            if (read_exact(fd, (char *)&hello, sizeof(hello), 1000) && hello == pool->token)
+            {
+                int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (const char *)&on, sizeof(on));
+                slot.conn = fd;
+                return true;
+            }
+            close_socket(fd); // not our worker
+        }
+        stop_slot_process(slot);
+        return false;
+    }
+
+    // IResponse::content_type is a plain pointer, so the types workers answer with are kept for the process lifetime
+    static const char *intern_content_type(const acul::string &type)
+    {
+        static std::mutex lock;
+        static acul::hashmap<acul::string, acul::string *> types;
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = types.find(type);
+        if (it == types.end()) it = types.emplace(type, acul::alloc<acul::string>(type)).first;
+        return it->second->c_str();
+    }
+
+    // An idle worker never writes, so anything readable means it has exited
+    static bool connection_alive(socket_t fd)
+    {
+        pollfd_t p{fd, POLLIN, 0};
+        return poll_sockets(&p, 1, 0) == 0;
+    }
+
+    static bool exchange(WorkerSlot &slot, detail::WorkerJob &job)
+    {
+        if (!send_all(slot.conn, job.frame.data(), job.frame.size())) return false;
+
+        ResultHeader h;
+        if (!read_exact(slot.conn, (char *)&h, sizeof(h), pool->timeout_ms, &pool->stopping)) return false;
+        acul::string type(h.type_size, '\0');
+        if (!read_exact(slot.conn, type.data(), type.size(), pool->timeout_ms, &pool->stopping)) return false;
+        if (h.failed)
+        {
+            // Kept out of job.error until complete, so a timeout is reported as one rather than as zero bytes
+            acul::string error(h.body_size, '\0');
+            if (!read_exact(slot.conn, error.data(), error.size(), pool->timeout_ms, &pool->stopping)) return false;
+            job.error = std::move(error);
+            return true;
+        }
+
+        // Straight into the buffer the web view is handed; no intermediate copy
+        auto *res = acul::alloc<BinaryResponse>(intern_content_type(type));
+        res->content.resize(h.body_size);
+        if (!read_exact(slot.conn, res->content.data(), h.body_size, pool->timeout_ms, &pool->stopping))
+        {
+            acul::release(res);
+            return false;
+        }
+        job.res = res;
+        return true;
+    }
+
+    // One thread per worker process: takes the next job, waits for its result and restarts the worker when it
+    // crashes or times out. Jobs go to whichever worker is free, so load spreads across the processes.
+    static void supervise(WorkerSlot *slot)
+    {
+        while (!pool->stopping.load(std::memory_order_acquire))
+        {
+            if (!slot->running && !launch_worker(*slot))
+            {
+                LOG_ERROR("Failed to start a worker process");
+                std::unique_lock<std::mutex> lock(pool->lock);
+                pool->cv.wait_for(lock, std::chrono::milliseconds(restart_delay_ms),
+                                  [] { return pool->stopping.load(std::memory_order_acquire); });
+                continue;
+            }
+
+            detail::WorkerJob *job;
+            {
+                std::unique_lock<std::mutex> lock(pool->lock);
+                auto ready = [] { return pool->stopping.load(std::memory_order_acquire) || !pool->queue.empty(); };
+                pool->cv.wait(lock, ready);
+                if (pool->stopping.load(std::memory_order_acquire)) break;
+                job = pool->queue.front();
+                pool->queue.erase(pool->queue.begin());
+            }
+
+            if (!connection_alive(slot->conn))
+            {
+                LOG_WARN("Worker process exited while idle; restarting it");
+                stop_slot_process(*slot);
+                if (!launch_worker(*slot))
+                {
+                    job->error = "Failed to restart a worker process";
+                    detail::resume_on_main(job->caller, job->window);
+                    continue;
+                }
+            }
+            if (!exchange(*slot, *job))
+            {
+                if (pool->stopping.load(std::memory_order_acquire)) break;
+                if (job->error.empty()) job->error = "Worker process crashed or timed out";
+                LOG_WARN("%s; restarting it", job->error.c_str());
+                stop_slot_process(*slot);
+            }
+            detail::resume_on_main(job->caller, job->window);
+        }
+        stop_slot_process(*slot);
+    }
+
+    void start_worker_pool(u32 processes, u32 timeout_ms)
+    {
+#ifdef _WIN32
+        WSADATA wsa;
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return;
+#endif
+        pool = acul::alloc<WorkerPool>();
+        pool->timeout_ms = timeout_ms;
+        pool->token = std::random_device{}() | ((u64)std::random_device{}() << 32);
+        for (u32 i = 0; i < processes; ++i)
+        {
+            auto *slot = acul::alloc<WorkerSlot>();
+            slot->thread = std::thread(supervise, slot);
+            pool->slots.push_back(slot);
+        }
+        LOG_INFO("Started %u worker processes", processes);
+    }
+
+    void stop_worker_pool()
+    {
+        if (!pool) return;
+        {
+            std::lock_guard<std::mutex> lock(pool->lock);
+            pool->stopping.store(true, std::memory_order_release);
+        }
+        pool->cv.notify_all();
+        for (auto *slot : pool->slots)
+        {
+            slot->thread.join();
+            if (slot->listener != INVALID_SOCKET) close_socket(slot->listener);
+            acul::release(slot);
+        }
+        // Queued jobs are dropped with the main loop that would have resumed them
+        acul::release(pool);
+        pool = nullptr;
+    }
+
+    namespace detail
+    {
+        static const struct
+        {
+            const ACUL_NATIVE_CHAR *name;
+            const char *key;
+        } forwarded_headers[] = {{ACUL_C_STR("Accept"), "accept"},
+                                 {ACUL_C_STR("Content-Type"), "content-type"},
+                                 {ACUL_C_STR("X-Requested-With"), "x-requested-with"}};
+
+        void encode_worker_job(WorkerJob &job, const char *name, const Request &req)
+        {
+            acul::string headers;
+            auto add = [&headers](const acul::string &key, const acul::string &value) {
+                headers.append(key.c_str(), key.c_str() + key.size() + 1);
+                headers.append(value.c_str(), value.c_str() + value.size() + 1);
+            };
+            if (req.headers)
+                for (auto &[key, value] : *req.headers) add(key, value);
+            else
+                for (auto &header : forwarded_headers)
+                    if (auto value = req.get_header(header.name); !value.empty()) add(header.key, value);
+
+            JobHeader h{(u32)req.method, (u32)strlen(name), (u32)req.path.size(), (u32)req.query.size(),
+                        (u32)headers.size(), req.body.size()};
+            job.frame.reserve(sizeof(h) + h.name_size + h.path_size + h.query_size + h.headers_size + h.body_size);
+            job.frame.append((const char *)&h, (const char *)&h + sizeof(h));
+            job.frame.append(name, name + h.name_size);
+            job.frame.append(req.path.c_str(), req.path.c_str() + h.path_size);
+            job.frame.append(req.query.c_str(), req.query.c_str() + h.query_size);
+            job.frame.append(headers.c_str(), headers.c_str() + h.headers_size);
+            job.frame.append(req.body.c_str(), req.body.c_str() + h.body_size);
+        }
+
+        bool submit_worker_job(WorkerJob *job)
+        {
+            if (!pool)
+            {
+                job->error = "Worker pool is not running";
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(pool->lock);
+                pool->queue.push_back(job);
+            }
+            pool->cv.notify_one();
+            return true;
+        }
+    } // namespace detail
+
+    RouteHandler worker_route(const char *name)
+    {
+        acul::string job = name;
+        return async_route(
+            [job](Request req) -> Task<IResponse *> { co_return co_await run_in_worker(job.c_str(), req); });
+    }
+
+    static Task<> forward_message(acul::string job, acul::string json)
+    {
+        Request req;
+        req.method = Method::post;
+        req.body = std::move(json);
+        req.request_ctx = nullptr;
+        IResponse *res = co_await run_in_worker(job.c_str(), req);
+        acul::release(res);
+    }
+
+    EventHandler worker_handler(const char *name)
+    {
+        acul::string job = name;
+        return [job](const rapidjson::Value &value) {
+            rapidjson::StringBuffer buf;
+            rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+            value.Accept(w);
+            spawn(forward_message(job, acul::string(buf.GetString(), buf.GetSize())));
+        };
+    }
+} // namespace alwf
@@ -0,0 +1,77 @@
+# Collects the static assets each view loads (script(src=...) and link(href=...)) from the view and every template
+# listed in its ahtt dep file, and writes them to templates/<view>_assets.hpp. All views are handled in one run so
+# shared layouts are read once; headers whose content did not change keep their timestamp.
+# Usage: cmake -DVIEW_LIST=<file> -P asset_deps.cmake, where each line of the list is "<name>|<at file>|<dep file>|<header>"
+
+cmake_minimum_required(VERSION 3.17)
+
+function(collect_source_assets SOURCE OUT)
+    string(MD5 KEY "${SOURCE}")
+    get_property(CACHED GLOBAL PROPERTY ASSETS_${KEY} SET)
+    if(NOT CACHED)
+        file(READ "${SOURCE}" TEXT)
+        string(REGEX MATCHALL "script\\([^)]*src=\"[^\"]+\"" SCRIPTS "${TEXT}")
+        string(REGEX MATCHALL "link\\([^)]*href=\"[^\"]+\"" LINKS "${TEXT}")
+        set(FOUND)
+        foreach(TAG ${SCRIPTS} ${LINKS})
+            string(REGEX REPLACE ".*(src|href)=\"([^\"]+)\"$" "\\2" URL "${TAG}")
+            # Skip external URLs and interpolated values that are only known at render time
+            if(URL MATCHES "://" OR URL MATCHES "^//" OR URL MATCHES "#{")
+                continue()
+            endif()
+            string(REGEX REPLACE "[?#].*$" "" URL "${URL}")
+            if(NOT URL MATCHES "^/")
+                set(URL "/${URL}")
+            endif()
+            list(APPEND FOUND "${URL}")
+        endforeach()
+        set_property(GLOBAL PROPERTY ASSETS_${KEY} "${FOUND}")
+    endif()
+    get_property(FOUND GLOBAL PROPERTY ASSETS_${KEY})
+    set(${OUT} "${FOUND}" PARENT_SCOPE)
+endfunction()
+
+function(write_view_assets VIEW AT_FILE DEP_FILE OUT_HEADER)
+    set(SOURCES "${AT_FILE}")
+    if(EXISTS "${DEP_FILE}")
+        file(READ "${DEP_FILE}" DEPS)
+        string(REGEX REPLACE "^[^:]*:" "" DEPS "${DEPS}")
+        string(REPLACE "\\\n" " " DEPS "${DEPS}")
+        string(REGEX REPLACE "[ \t\r\n]+" ";" DEPS "${DEPS}")
+        foreach(DEP ${DEPS})
+            if(DEP MATCHES "\\.at$")
+                list(APPEND SOURCES "${DEP}")
+            endif()
+        endforeach()
+    endif()
+    list(REMOVE_DUPLICATES SOURCES)
+
+    set(ASSETS)
+    foreach(SOURCE ${SOURCES})
+        collect_source_assets("${SOURCE}" FOUND)
+        list(APPEND ASSETS ${FOUND})
+    endforeach()
+    list(REMOVE_DUPLICATES ASSETS)
+
+    set(ITEMS "")
+    foreach(URL ${ASSETS})
+        string(APPEND ITEMS "\"${URL}\", ")
+    endforeach()
+
+    set(CONTENT "#pragma once\n\nnamespace ahtt::${VIEW}::assets\n{\n")
+    string(APPEND CONTENT "    inline constexpr const char *items[] = {${ITEMS}nullptr};\n")
+    string(APPEND CONTENT "} // namespace ahtt::${VIEW}::assets\n")
+
+    if(EXISTS "${OUT_HEADER}")
+        file(READ "${OUT_HEADER}" PREVIOUS)
+    endif()
+    if(NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+        file(WRITE "${OUT_HEADER}" "${CONTENT}")
+    endif()
+endfunction()
+
+file(STRINGS "${VIEW_LIST}" VIEWS)
+foreach(ENTRY ${VIEWS})
+    string(REPLACE "|" ";" FIELDS "${ENTRY}")
+    write_view_assets(${FIELDS})
+endforeach()
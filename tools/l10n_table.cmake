@@ -0,0 +1,126 @@
+# Compiles .po catalogs into a constant string table, templates/strings.hpp: one row per language and one
+# enumerator per msgid, so translated strings are array lookups instead of gettext calls.
+# Usage: cmake -DLOCALES_SRC=<dir> -DOUT_HEADER=<file> -P l10n_table.cmake
+
+cmake_minimum_required(VERSION 3.17)
+
+file(GLOB_RECURSE PO_FILES "${LOCALES_SRC}/*.po")
+list(SORT PO_FILES)
+
+# C++ keywords and the names the generated header itself declares
+set(RESERVED_NAMES
+    alignas alignof and asm auto bool break case catch char class const constexpr continue default delete do double
+    else enum explicit export extern false float for friend goto if inline int long mutable namespace new noexcept
+    not nullptr operator or private protected public register return short signed sizeof static struct switch
+    template this throw true try typedef typename union unsigned using virtual void volatile while xor
+    count language_count languages msgids rows table)
+
+set(LANGUAGES)
+set(MSGIDS)
+
+macro(store_entry)
+    if(DEFINED ENTRY_ID AND NOT ENTRY_ID STREQUAL "" AND NOT ENTRY_PLURAL)
+        string(MD5 KEY "${ENTRY_ID}")
+        if(NOT DEFINED ID_${KEY})
+            set(ID_${KEY} "${ENTRY_ID}")
+            list(APPEND MSGIDS "${KEY}")
+        endif()
+        if(NOT ENTRY_STR STREQUAL "")
+            set(STR_${LANG}_${KEY} "${ENTRY_STR}")
+        endif()
+    endif()
+    unset(ENTRY_ID)
+    set(ENTRY_STR "")
+    set(ENTRY_PLURAL OFF)
+endmacro()
+
+foreach(PO_FILE ${PO_FILES})
+    get_filename_component(DIR "${PO_FILE}" DIRECTORY)
+    get_filename_component(LANG "${DIR}" NAME)
+    if(NOT LANG IN_LIST LANGUAGES)
+        list(APPEND LANGUAGES "${LANG}")
+    endif()
+
+    file(READ "${PO_FILE}" TEXT)
+    # List separators and brackets would break CMake list handling; octal escapes are valid in the C++ literals
+    string(REPLACE ";" "\\073" TEXT "${TEXT}")
+    string(REPLACE "[" "\\133" TEXT "${TEXT}")
+    string(REPLACE "]" "\\135" TEXT "${TEXT}")
+    string(REPLACE "\r" "" TEXT "${TEXT}")
+    string(REPLACE "\n" ";" LINES "${TEXT}")
+
+    set(FIELD "")
+    set(ENTRY_STR "")
+    set(ENTRY_PLURAL OFF)
+    unset(ENTRY_ID)
+    foreach(LINE IN LISTS LINES)
+        if(LINE MATCHES "^msgid \"(.*)\"$")
+            store_entry()
+            set(ENTRY_ID "${CMAKE_MATCH_1}")
+            set(FIELD "id")
+        elseif(LINE MATCHES "^msgid_plural ")
+            set(ENTRY_PLURAL ON)
+            set(FIELD "")
+        elseif(LINE MATCHES "^msgstr \"(.*)\"$")
+            set(ENTRY_STR "${CMAKE_MATCH_1}")
+            set(FIELD "str")
+        elseif(LINE MATCHES "^\"(.*)\"$")
+            if(FIELD STREQUAL "id")
+                string(APPEND ENTRY_ID "${CMAKE_MATCH_1}")
+            elseif(FIELD STREQUAL "str")
+                string(APPEND ENTRY_STR "${CMAKE_MATCH_1}")
+            endif()
+        else()
+            set(FIELD "")
+        endif()
+    endforeach()
+    store_entry()
+endforeach()
+
+# Enumerator names are the msgids reduced to identifiers; ids that collide after that are reachable by lookup() only
+set(ENUMERATORS "")
+set(MSGID_ITEMS "")
+set(USED_NAMES)
+set(INDEX 0)
+foreach(KEY ${MSGIDS})
+    string(MAKE_C_IDENTIFIER "${ID_${KEY}}" NAME)
+    if(NAME IN_LIST RESERVED_NAMES)
+        set(NAME "${NAME}_")
+    endif()
+    if(NAME IN_LIST USED_NAMES)
+        message(WARNING "l10n: msgid \"${ID_${KEY}}\" maps to duplicate identifier '${NAME}'")
+    else()
+        list(APPEND USED_NAMES "${NAME}")
+        string(APPEND ENUMERATORS "        ${NAME} = ${INDEX},\n")
+    endif()
+    string(APPEND MSGID_ITEMS "\n        \"${ID_${KEY}}\",")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+set(LANGUAGE_ITEMS "")
+set(ROWS "")
+foreach(LANG ${LANGUAGES})
+    string(APPEND LANGUAGE_ITEMS "\"${LANG}\", ")
+    string(APPEND ROWS "        // ${LANG}")
+    foreach(KEY ${MSGIDS})
+        if(DEFINED STR_${LANG}_${KEY})
+            string(APPEND ROWS "\n        \"${STR_${LANG}_${KEY}}\",")
+        else()
+            string(APPEND ROWS "\n        \"${ID_${KEY}}\",")
+        endif()
+    endforeach()
+    string(APPEND ROWS "\n")
+endforeach()
+list(LENGTH LANGUAGES LANGUAGE_COUNT)
+
+set(CONTENT "#pragma once\n\n#include <alwf/l10n.hpp>\n\nnamespace alwf::strings\n{\n")
+string(APPEND CONTENT "    enum : u32\n    {\n${ENUMERATORS}    };\n\n")
+string(APPEND CONTENT "    inline constexpr u32 count = ${INDEX};\n")
+string(APPEND CONTENT "    inline constexpr u32 language_count = ${LANGUAGE_COUNT};\n")
+string(APPEND CONTENT "    inline constexpr const char *languages[] = {${LANGUAGE_ITEMS}nullptr};\n")
+string(APPEND CONTENT "    inline constexpr const char *msgids[] = {${MSGID_ITEMS}\n        nullptr};\n")
+string(APPEND CONTENT "    inline constexpr const char *rows[] = {\n${ROWS}        nullptr};\n\n")
+string(APPEND CONTENT "    inline constexpr StringTable table{languages, language_count, msgids, count, rows};\n")
+string(APPEND CONTENT "} // namespace alwf::strings\n")
+
+file(WRITE "${OUT_HEADER}" "${CONTENT}")
@@ -0,0 +1,44 @@
+// Renders views without runtime inputs at build time and emits them as constexpr byte arrays.
+// The view list is generated by alwf.cmake from ALWF_STATIC_VIEWS. Views are rendered once in the build host's
+// locale and set_language() does not apply to them, so they must not use gettext or alwf::tr().
+#include <cstdio>
+#include <type_traits>
+#include "prerender_views.hpp"
+
+static bool write_view(const char *dir, const char *name, const acul::string &html)
+{
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/%s_static.hpp", dir, name);
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+
+    fprintf(f, "#pragma once\n#include <cstddef>\n\nnamespace ahtt::%s::prerendered\n{\n", name);
+    fprintf(f, "    inline constexpr char data[] = {");
+    for (size_t i = 0; i < html.size(); ++i)
+    {
+        if (i % 16 == 0) fputs("\n        ", f);
+        fprintf(f, "%d,", (int)(signed char)html[i]);
+    }
+    fprintf(f, "0};\n    inline constexpr size_t size = %zu;\n} // namespace ahtt::%s::prerendered\n", html.size(), name);
+    return fclose(f) == 0;
+}
+
+#define ALWF_PRERENDER_VIEW(name)                                                                   \
+    static_assert(std::is_invocable_v<decltype(&ahtt::name::render)>,                               \
+                  "View '" #name "' takes runtime inputs and cannot be prerendered");               \
+    if (!write_view(argv[1], #name, ahtt::name::render()))                                          \
+    {                                                                                               \
+        fprintf(stderr, "alwf_prerender: failed to write view '%s'\n", #name);                      \
+        return 1;                                                                                   \
+    }
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: alwf_prerender <output-dir>\n");
+        return 1;
+    }
+    ALWF_STATIC_VIEW_LIST(ALWF_PRERENDER_VIEW)
+    return 0;
+}
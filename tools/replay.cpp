@@ -0,0 +1,212 @@
+// Replays an Options::capture_file recording through the dispatch core without a web view.
+// Usage: alwf_replay <capture> [--realtime] [--out results.jsonl] [--baseline results.jsonl]
+// Prints latency percentiles and operator new calls per request path and message handler. --out saves them as
+// JSON lines; --baseline compares against a file saved by another build.
+#include <algorithm>
+#include <alwf/replay.hpp>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include "headless.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Series
+    {
+        acul::vector<u64> ns;
+        u64 allocs = 0;
+    };
+
+    struct Result
+    {
+        u64 count;
+        double p50_us;
+        double p99_us;
+        double allocs_per_op;
+    };
+
+    acul::string key_of(const alwf::CaptureRecord &r)
+    {
+        if (r.kind == alwf::CaptureKind::request)
+            return acul::format("%s %s", alwf::method_name(r.method), r.path.c_str());
+        rapidjson::Document doc;
+        doc.Parse(r.json.c_str(), r.json.size());
+        if (!doc.HasParseError() && doc.IsObject())
+        {
+            auto h = doc.FindMember("handler");
+            if (h != doc.MemberEnd() && h->value.IsString()) return acul::format("message %s", h->value.GetString());
+        }
+        return "message ?";
+    }
+
+    Result summarize(Series &s)
+    {
+        std::sort(s.ns.begin(), s.ns.end());
+        auto at = [&](double q) { return (double)s.ns[(size_t)(q * (double)(s.ns.size() - 1))] / 1000.0; };
+        return {(u64)s.ns.size(), at(0.5), at(0.99), (double)s.allocs / (double)s.ns.size()};
+    }
+
+    bool load_baseline(const char *path, acul::hashmap<acul::string, Result> &out)
+    {
+        FILE *f = fopen(path, "rb");
+        if (!f) return false;
+        char line[4096];
+        while (fgets(line, sizeof(line), f))
+        {
+            rapidjson::Document doc;
+            doc.Parse(line);
+            if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("name")) continue;
+            out[doc["name"].GetString()] = {doc["count"].GetUint64(), doc["p50_us"].GetDouble(),
+                                            doc["p99_us"].GetDouble(), doc["allocs_per_op"].GetDouble()};
+        }
+        fclose(f);
+        return true;
+    }
+
+    // One JSON line of --out; names are request paths and handler names, so they go through the writer's escaping
+    void write_result(FILE *f, const acul::string &name, const Result &r)
+    {
+        rapidjson::StringBuffer buf;
+        rapidjson::Writer<rapidjson::StringBuffer> w(buf);
+        w.StartObject();
+        w.Key("name");
+        w.String(name.c_str(), (rapidjson::SizeType)name.size());
+        w.Key("count");
+        w.Uint64(r.count);
+        w.Key("p50_us");
+        w.Double(r.p50_us);
+        w.Key("p99_us");
+        w.Double(r.p99_us);
+        w.Key("allocs_per_op");
+        w.Double(r.allocs_per_op);
+        w.EndObject();
+        fprintf(f, "%s\n", buf.GetString());
+    }
+
+    double percent(double now, double before) { return before > 0 ? (now - before) * 100.0 / before : 0.0; }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const char *capture = nullptr;
+    const char *out_path = nullptr;
+    const char *baseline_path = nullptr;
+    bool realtime = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--realtime") == 0) realtime = true;
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out_path = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baseline_path = argv[++i];
+        else capture = argv[i];
+    }
+    if (!capture)
+    {
+        fprintf(stderr, "usage: alwf_replay <capture> [--realtime] [--out results.jsonl] [--baseline results.jsonl]\n");
+        return 1;
+    }
+
+    acul::vector<alwf::CaptureRecord> records;
+    if (!alwf::read_capture(capture, records))
+    {
+        fprintf(stderr, "alwf_replay: %s is not a readable capture\n", capture);
+        return 1;
+    }
+    acul::hashmap<acul::string, Result> baseline;
+    if (baseline_path && !load_baseline(baseline_path, baseline))
+    {
+        fprintf(stderr, "alwf_replay: cannot read baseline %s\n", baseline_path);
+        return 1;
+    }
+
+    alwf::Options opt;
+    alwf::replay_setup(opt);
+    if (!opt.router)
+    {
+        fprintf(stderr, "alwf_replay: replay_setup() did not set a router\n");
+        return 1;
+    }
+    alwf::ctx = acul::alloc<alwf::Context>();
+    alwf::ctx->static_folder = opt.static_folder;
+    alwf::ctx->router = opt.router;
+    alwf::ctx->handler_router = opt.handler_router;
+    alwf::ctx->call_router = opt.call_router;
+    alwf::ctx->strings = opt.strings;
+    alwf::ctx->call_timeout_ms = opt.call_timeout_ms;
+    alwf::ctx->blob_ttl_ms = opt.blob_ttl_ms;
+    alwf::ctx->prerender_links = opt.prerender_links;
+    alwf::ctx->prerender_budget = opt.prerender_budget;
+    alwf::ctx->prerender_ttl_ms = opt.prerender_ttl_ms;
+    alwf::ctx->memory_low_water = opt.memory_low_water;
+
+    acul::hashmap<acul::string, Series> series;
+    acul::vector<acul::string> order;
+    u64 recorded_outbound = 0;
+    const auto start = Clock::now();
+    for (auto &r : records)
+    {
+        if (r.kind == alwf::CaptureKind::outbound)
+        {
+            ++recorded_outbound;
+            continue;
+        }
+        if (realtime) std::this_thread::sleep_until(start + std::chrono::microseconds(r.ts_us));
+
+        acul::string key = key_of(r);
+        auto it = series.find(key);
+        if (it == series.end())
+        {
+            order.push_back(key);
+            it = series.emplace(key, Series{}).first;
+        }
+
+        const u64 allocs_before = alwf::allocation_count();
+        const auto t0 = Clock::now();
+        if (r.kind == alwf::CaptureKind::request)
+        {
+            alwf::Request req;
+            req.method = r.method;
+            req.path = r.path;
+            req.query = r.query;
+            req.body = r.body;
+            req.request_ctx = nullptr;
+            req.headers = &r.headers;
+            alwf::DispatchResult result = alwf::dispatch_request(req);
+            if (result.kind == alwf::DispatchKind::owned) acul::release(result.res);
+            else if (result.kind == alwf::DispatchKind::deferred)
+                result.pending->finish = [](const alwf::DispatchResult &done) { acul::release(done.res); };
+        }
+        else alwf::dispatch_message(r.json.c_str());
+        const auto elapsed = Clock::now() - t0;
+        it->second.allocs += alwf::allocation_count() - allocs_before;
+        it->second.ns.push_back((u64)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+        alwf::drain_main_queue();
+    }
+
+    FILE *results = out_path ? fopen(out_path, "w") : nullptr;
+    if (out_path && !results) fprintf(stderr, "alwf_replay: cannot open %s\n", out_path);
+    printf("%-40s %8s %12s %12s %12s\n", "endpoint", "count", "p50 us", "p99 us", "allocs/op");
+    for (auto &key : order)
+    {
+        Result now = summarize(series[key]);
+        printf("%-40s %8llu %12.1f %12.1f %12.2f\n", key.c_str(), (unsigned long long)now.count, now.p50_us,
+               now.p99_us, now.allocs_per_op);
+        if (auto b = baseline.find(key); b != baseline.end())
+            printf("%-40s %8s %+11.1f%% %+11.1f%% %+12.2f\n", "  vs baseline", "", percent(now.p50_us, b->second.p50_us),
+                   percent(now.p99_us, b->second.p99_us), now.allocs_per_op - b->second.allocs_per_op);
+        if (results) write_result(results, key, now);
+    }
+    printf("outbound messages: %llu recorded, %llu replayed\n", (unsigned long long)recorded_outbound,
+           (unsigned long long)alwf::frontend_message_count());
+
+    if (results) fclose(results);
+    alwf::destroy_blobs();
+    alwf::destroy_prerender_cache();
+    alwf::destroy_route_cache();
+    alwf::destroy_page_assets();
+    acul::release(alwf::ctx);
+    alwf::ctx = nullptr;
+    return 0;
+}